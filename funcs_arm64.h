@@ -10,6 +10,10 @@
  * Ptr = with pointer, Index = access as array[i]
  * Simple/Unroll = 1 or 16 operations per loop,
  *     Multi = ARM multi-register operation
+ * Chain2..32 = walk 2 to 32 independent permutation cycles at once
+ * Skip = access one 64-bit word every g_stride bytes (option -k)
+ *
+ * Stream Copy/Scale/Add/Triad = the four STREAM kernels on two or three arrays
  *
  ******************************************************************************
  * Copyright (C) 2013-2016 Timo Bingmann <tb@panthema.net>
@@ -406,6 +410,201 @@ void ScanRead64PtrUnrollLoop(char* memarea, size_t size, size_t repeats)
 
 REGISTER(ScanRead64PtrUnrollLoop, 8, 8, 16);
 
+// 64-bit writer skipping forward g_stride bytes between accesses (Assembler
+// version)
+void SkipWrite64PtrSimpleLoop(char* memarea, size_t size, size_t repeats)
+{
+    uint64_t value = 0xC0FFEEEEBABE0000;
+
+    asm volatile(
+        "1: \n" // start of repeat loop
+        "mov    x0, %[memarea] \n"     // x0 = reset loop iterator
+        "2: \n" // start of write loop
+        "str    %[value], [x0] \n"
+        "add    x0, x0, %[stride] \n"
+        // test write loop condition
+        "cmp    x0, %[end] \n"          // compare to end iterator
+        "blo    2b \n"
+        // test repeat loop condition
+        "subs   %[repeats], %[repeats], #1 \n" // until repeats = 0
+        "bne    1b \n"
+        : [repeats] "+r" (repeats)
+        : [memarea] "r" (memarea), [end] "r" (memarea+size),
+          [value] "r" (value), [stride] "r" (g_stride)
+        : "x0", "cc", "memory");
+}
+
+REGISTER_STRIDE(SkipWrite64PtrSimpleLoop, 8);
+
+// 64-bit reader skipping forward g_stride bytes between accesses (Assembler
+// version)
+void SkipRead64PtrSimpleLoop(char* memarea, size_t size, size_t repeats)
+{
+    asm volatile(
+        "1: \n" // start of repeat loop
+        "mov    x0, %[memarea] \n"     // x0 = reset loop iterator
+        "2: \n" // start of read loop
+        "ldr    x1, [x0] \n"
+        "add    x0, x0, %[stride] \n"
+        // test read loop condition
+        "cmp    x0, %[end] \n"          // compare to end iterator
+        "blo    2b \n"
+        // test repeat loop condition
+        "subs   %[repeats], %[repeats], #1 \n" // until repeats = 0
+        "bne    1b \n"
+        : [repeats] "+r" (repeats)
+        : [memarea] "r" (memarea), [end] "r" (memarea+size),
+          [stride] "r" (g_stride)
+        : "x0", "x1", "cc", "memory");
+}
+
+REGISTER_STRIDE(SkipRead64PtrSimpleLoop, 8);
+
+// ****************************************************************************
+// ----------------------------------------------------------------------------
+// Multi-Array Operations (STREAM Copy, Scale, Add and Triad on doubles)
+// ----------------------------------------------------------------------------
+// ****************************************************************************
+
+// 128-bit STREAM Copy b[i] = a[i] in an unrolled loop (Assembler version)
+void StreamCopy128PtrUnrollLoop(char* memarea, size_t size, size_t repeats)
+{
+    asm volatile(
+        "1: \n" // start of repeat loop
+        "mov    x0, %[a] \n"            // x0 = reset iterator of a
+        "mov    x1, %[b] \n"            // x1 = reset iterator of b
+        "2: \n" // start of array loop
+        "ldp    q0, q1, [x0, #0*32] \n"
+        "ldp    q2, q3, [x0, #1*32] \n"
+        "stp    q0, q1, [x1, #0*32] \n"
+        "stp    q2, q3, [x1, #1*32] \n"
+        "add    x0, x0, #4*16 \n"       // add offset
+        "add    x1, x1, #4*16 \n"
+        // test array loop condition
+        "cmp    x0, %[end] \n"          // compare to end iterator of a
+        "blo    2b \n"
+        // test repeat loop condition
+        "subs   %[repeats], %[repeats], #1 \n" // until repeats = 0
+        "bne    1b \n"
+        : [repeats] "+r" (repeats)
+        : [a] "r" (memarea), [b] "r" (memarea+size), [end] "r" (memarea+size)
+        : "x0", "x1", "v0", "v1", "v2", "v3", "cc", "memory");
+}
+
+REGISTER_STREAMS(StreamCopy128PtrUnrollLoop, NULL, 16, 4, 2);
+
+// 128-bit STREAM Scale b[i] = scalar * a[i] in an unrolled loop (Assembler version)
+void StreamScale128PtrUnrollLoop(char* memarea, size_t size, size_t repeats)
+{
+    double scalar = 3.0;
+
+    asm volatile(
+        "ld1r   {v16.2d}, [%[scalar]] \n" // v16 = scalar in both lanes
+        "1: \n" // start of repeat loop
+        "mov    x0, %[a] \n"            // x0 = reset iterator of a
+        "mov    x1, %[b] \n"            // x1 = reset iterator of b
+        "2: \n" // start of array loop
+        "ldp    q0, q1, [x0, #0*32] \n"
+        "ldp    q2, q3, [x0, #1*32] \n"
+        "fmul   v0.2d, v0.2d, v16.2d \n"
+        "fmul   v1.2d, v1.2d, v16.2d \n"
+        "fmul   v2.2d, v2.2d, v16.2d \n"
+        "fmul   v3.2d, v3.2d, v16.2d \n"
+        "stp    q0, q1, [x1, #0*32] \n"
+        "stp    q2, q3, [x1, #1*32] \n"
+        "add    x0, x0, #4*16 \n"       // add offset
+        "add    x1, x1, #4*16 \n"
+        // test array loop condition
+        "cmp    x0, %[end] \n"          // compare to end iterator of a
+        "blo    2b \n"
+        // test repeat loop condition
+        "subs   %[repeats], %[repeats], #1 \n" // until repeats = 0
+        "bne    1b \n"
+        : [repeats] "+r" (repeats)
+        : [a] "r" (memarea), [b] "r" (memarea+size), [end] "r" (memarea+size),
+          [scalar] "r" (&scalar)
+        : "x0", "x1", "v0", "v1", "v2", "v3", "v16", "cc", "memory");
+}
+
+REGISTER_STREAMS(StreamScale128PtrUnrollLoop, NULL, 16, 4, 2);
+
+// 128-bit STREAM Add c[i] = a[i] + b[i] in an unrolled loop (Assembler version)
+void StreamAdd128PtrUnrollLoop(char* memarea, size_t size, size_t repeats)
+{
+    asm volatile(
+        "1: \n" // start of repeat loop
+        "mov    x0, %[a] \n"            // x0 = reset iterator of a
+        "mov    x1, %[b] \n"            // x1 = reset iterator of b
+        "mov    x2, %[c] \n"            // x2 = reset iterator of c
+        "2: \n" // start of array loop
+        "ldp    q0, q1, [x0, #0*32] \n"
+        "ldp    q2, q3, [x0, #1*32] \n"
+        "ldp    q4, q5, [x1, #0*32] \n"
+        "ldp    q6, q7, [x1, #1*32] \n"
+        "fadd   v0.2d, v0.2d, v4.2d \n"
+        "fadd   v1.2d, v1.2d, v5.2d \n"
+        "fadd   v2.2d, v2.2d, v6.2d \n"
+        "fadd   v3.2d, v3.2d, v7.2d \n"
+        "stp    q0, q1, [x2, #0*32] \n"
+        "stp    q2, q3, [x2, #1*32] \n"
+        "add    x0, x0, #4*16 \n"       // add offset
+        "add    x1, x1, #4*16 \n"
+        "add    x2, x2, #4*16 \n"
+        // test array loop condition
+        "cmp    x0, %[end] \n"          // compare to end iterator of a
+        "blo    2b \n"
+        // test repeat loop condition
+        "subs   %[repeats], %[repeats], #1 \n" // until repeats = 0
+        "bne    1b \n"
+        : [repeats] "+r" (repeats)
+        : [a] "r" (memarea), [b] "r" (memarea+size), [c] "r" (memarea+2*size),
+          [end] "r" (memarea+size)
+        : "x0", "x1", "x2", "v0", "v1", "v2", "v3", "v4", "v5", "v6", "v7",
+          "cc", "memory");
+}
+
+REGISTER_STREAMS(StreamAdd128PtrUnrollLoop, NULL, 16, 4, 3);
+
+// 128-bit STREAM Triad a[i] = b[i] + scalar * c[i] in an unrolled loop (Assembler version)
+void StreamTriad128PtrUnrollLoop(char* memarea, size_t size, size_t repeats)
+{
+    double scalar = 3.0;
+
+    asm volatile(
+        "ld1r   {v16.2d}, [%[scalar]] \n" // v16 = scalar in both lanes
+        "1: \n" // start of repeat loop
+        "mov    x0, %[a] \n"            // x0 = reset iterator of a
+        "mov    x1, %[b] \n"            // x1 = reset iterator of b
+        "mov    x2, %[c] \n"            // x2 = reset iterator of c
+        "2: \n" // start of array loop
+        "ldp    q0, q1, [x1, #0*32] \n"
+        "ldp    q2, q3, [x1, #1*32] \n"
+        "ldp    q4, q5, [x2, #0*32] \n"
+        "ldp    q6, q7, [x2, #1*32] \n"
+        "fmla   v0.2d, v4.2d, v16.2d \n"
+        "fmla   v1.2d, v5.2d, v16.2d \n"
+        "fmla   v2.2d, v6.2d, v16.2d \n"
+        "fmla   v3.2d, v7.2d, v16.2d \n"
+        "stp    q0, q1, [x0, #0*32] \n"
+        "stp    q2, q3, [x0, #1*32] \n"
+        "add    x0, x0, #4*16 \n"       // add offset
+        "add    x1, x1, #4*16 \n"
+        "add    x2, x2, #4*16 \n"
+        // test array loop condition
+        "cmp    x0, %[end] \n"          // compare to end iterator of a
+        "blo    2b \n"
+        // test repeat loop condition
+        "subs   %[repeats], %[repeats], #1 \n" // until repeats = 0
+        "bne    1b \n"
+        : [repeats] "+r" (repeats)
+        : [a] "r" (memarea), [b] "r" (memarea+size), [c] "r" (memarea+2*size),
+          [end] "r" (memarea+size), [scalar] "r" (&scalar)
+        : "x0", "x1", "x2", "v0", "v1", "v2", "v3", "v4", "v5", "v6", "v7", "v16",
+          "cc", "memory");
+}
+
+REGISTER_STREAMS(StreamTriad128PtrUnrollLoop, NULL, 16, 4, 3);
+
 // ****************************************************************************
 // ----------------------------------------------------------------------------
 // Permutation Walking
@@ -489,4 +688,293 @@ void PermRead64UnrollLoop(char* memarea, size_t, size_t repeats)
 
 REGISTER_PERM(PermRead64UnrollLoop, 4);
 
+// follow 2 independent 64-bit permutation cycles at once (Assembler version)
+void PermRead64Chain2Loop(char* memarea, size_t, size_t repeats)
+{
+    asm volatile(
+        "mov    x0, %[memarea] \n"      // x0 = iterator of chain 0
+        "add    x1, %[memarea], #64 \n"
+        "1: \n" // start of repeat loop
+        "2: \n" // start of read loop
+        "ldr    x0, [x0] \n"
+        "ldr    x1, [x1] \n"
+        // test read loop condition
+        "cmp    x0, %[memarea] \n"      // compare chain 0 to its first iterator
+        "bne    2b \n"
+        // test repeat loop condition
+        "subs   %[repeats], %[repeats], #1 \n" // until repeats = 0
+        "bne    1b \n"
+        : [repeats] "+r" (repeats)
+        : [memarea] "r" (memarea)
+        : "x0", "x1", "cc", "memory");
+}
+
+REGISTER_PERM_CHAINS(PermRead64Chain2Loop, 8, 2);
+
+// follow 4 independent 64-bit permutation cycles at once (Assembler version)
+void PermRead64Chain4Loop(char* memarea, size_t, size_t repeats)
+{
+    asm volatile(
+        "mov    x0, %[memarea] \n"      // x0 = iterator of chain 0
+        "add    x1, %[memarea], #64 \n"
+        "add    x2, %[memarea], #128 \n"
+        "add    x3, %[memarea], #192 \n"
+        "1: \n" // start of repeat loop
+        "2: \n" // start of read loop
+        "ldr    x0, [x0] \n"
+        "ldr    x1, [x1] \n"
+        "ldr    x2, [x2] \n"
+        "ldr    x3, [x3] \n"
+        // test read loop condition
+        "cmp    x0, %[memarea] \n"      // compare chain 0 to its first iterator
+        "bne    2b \n"
+        // test repeat loop condition
+        "subs   %[repeats], %[repeats], #1 \n" // until repeats = 0
+        "bne    1b \n"
+        : [repeats] "+r" (repeats)
+        : [memarea] "r" (memarea)
+        : "x0", "x1", "x2", "x3", "cc", "memory");
+}
+
+REGISTER_PERM_CHAINS(PermRead64Chain4Loop, 8, 4);
+
+// follow 8 independent 64-bit permutation cycles at once (Assembler version)
+void PermRead64Chain8Loop(char* memarea, size_t, size_t repeats)
+{
+    asm volatile(
+        "mov    x0, %[memarea] \n"      // x0 = iterator of chain 0
+        "add    x1, %[memarea], #64 \n"
+        "add    x2, %[memarea], #128 \n"
+        "add    x3, %[memarea], #192 \n"
+        "add    x4, %[memarea], #256 \n"
+        "add    x5, %[memarea], #320 \n"
+        "add    x6, %[memarea], #384 \n"
+        "add    x7, %[memarea], #448 \n"
+        "1: \n" // start of repeat loop
+        "2: \n" // start of read loop
+        "ldr    x0, [x0] \n"
+        "ldr    x1, [x1] \n"
+        "ldr    x2, [x2] \n"
+        "ldr    x3, [x3] \n"
+        "ldr    x4, [x4] \n"
+        "ldr    x5, [x5] \n"
+        "ldr    x6, [x6] \n"
+        "ldr    x7, [x7] \n"
+        // test read loop condition
+        "cmp    x0, %[memarea] \n"      // compare chain 0 to its first iterator
+        "bne    2b \n"
+        // test repeat loop condition
+        "subs   %[repeats], %[repeats], #1 \n" // until repeats = 0
+        "bne    1b \n"
+        : [repeats] "+r" (repeats)
+        : [memarea] "r" (memarea)
+        : "x0", "x1", "x2", "x3", "x4", "x5", "x6", "x7", "cc", "memory");
+}
+
+REGISTER_PERM_CHAINS(PermRead64Chain8Loop, 8, 8);
+
+// follow 16 independent 64-bit permutation cycles at once (Assembler version)
+void PermRead64Chain16Loop(char* memarea, size_t, size_t repeats)
+{
+    // too many chains for registers: keep iterators in an array
+    char* iter[16];
+    for (unsigned int c = 0; c < 16; ++c)
+        iter[c] = memarea + 64 * c;
+
+    asm volatile(
+        "1: \n" // start of repeat loop
+        "2: \n" // start of read loop
+        "ldr    x0, [%[iter], #0] \n"
+        "ldr    x0, [x0] \n"
+        "str    x0, [%[iter], #0] \n"
+        "ldr    x1, [%[iter], #8] \n"
+        "ldr    x1, [x1] \n"
+        "str    x1, [%[iter], #8] \n"
+        "ldr    x2, [%[iter], #16] \n"
+        "ldr    x2, [x2] \n"
+        "str    x2, [%[iter], #16] \n"
+        "ldr    x3, [%[iter], #24] \n"
+        "ldr    x3, [x3] \n"
+        "str    x3, [%[iter], #24] \n"
+
+        "ldr    x0, [%[iter], #32] \n"
+        "ldr    x0, [x0] \n"
+        "str    x0, [%[iter], #32] \n"
+        "ldr    x1, [%[iter], #40] \n"
+        "ldr    x1, [x1] \n"
+        "str    x1, [%[iter], #40] \n"
+        "ldr    x2, [%[iter], #48] \n"
+        "ldr    x2, [x2] \n"
+        "str    x2, [%[iter], #48] \n"
+        "ldr    x3, [%[iter], #56] \n"
+        "ldr    x3, [x3] \n"
+        "str    x3, [%[iter], #56] \n"
+
+        "ldr    x0, [%[iter], #64] \n"
+        "ldr    x0, [x0] \n"
+        "str    x0, [%[iter], #64] \n"
+        "ldr    x1, [%[iter], #72] \n"
+        "ldr    x1, [x1] \n"
+        "str    x1, [%[iter], #72] \n"
+        "ldr    x2, [%[iter], #80] \n"
+        "ldr    x2, [x2] \n"
+        "str    x2, [%[iter], #80] \n"
+        "ldr    x3, [%[iter], #88] \n"
+        "ldr    x3, [x3] \n"
+        "str    x3, [%[iter], #88] \n"
+
+        "ldr    x0, [%[iter], #96] \n"
+        "ldr    x0, [x0] \n"
+        "str    x0, [%[iter], #96] \n"
+        "ldr    x1, [%[iter], #104] \n"
+        "ldr    x1, [x1] \n"
+        "str    x1, [%[iter], #104] \n"
+        "ldr    x2, [%[iter], #112] \n"
+        "ldr    x2, [x2] \n"
+        "str    x2, [%[iter], #112] \n"
+        "ldr    x3, [%[iter], #120] \n"
+        "ldr    x3, [x3] \n"
+        "str    x3, [%[iter], #120] \n"
+        // test read loop condition
+        "ldr    x0, [%[iter]] \n"
+        "cmp    x0, %[memarea] \n"      // compare chain 0 to its first iterator
+        "bne    2b \n"
+        // test repeat loop condition
+        "subs   %[repeats], %[repeats], #1 \n" // until repeats = 0
+        "bne    1b \n"
+        : [repeats] "+r" (repeats)
+        : [memarea] "r" (memarea), [iter] "r" (iter)
+        : "x0", "x1", "x2", "x3", "cc", "memory");
+}
+
+REGISTER_PERM_CHAINS(PermRead64Chain16Loop, 8, 16);
+
+// follow 32 independent 64-bit permutation cycles at once (Assembler version)
+void PermRead64Chain32Loop(char* memarea, size_t, size_t repeats)
+{
+    // too many chains for registers: keep iterators in an array
+    char* iter[32];
+    for (unsigned int c = 0; c < 32; ++c)
+        iter[c] = memarea + 64 * c;
+
+    asm volatile(
+        "1: \n" // start of repeat loop
+        "2: \n" // start of read loop
+        "ldr    x0, [%[iter], #0] \n"
+        "ldr    x0, [x0] \n"
+        "str    x0, [%[iter], #0] \n"
+        "ldr    x1, [%[iter], #8] \n"
+        "ldr    x1, [x1] \n"
+        "str    x1, [%[iter], #8] \n"
+        "ldr    x2, [%[iter], #16] \n"
+        "ldr    x2, [x2] \n"
+        "str    x2, [%[iter], #16] \n"
+        "ldr    x3, [%[iter], #24] \n"
+        "ldr    x3, [x3] \n"
+        "str    x3, [%[iter], #24] \n"
+
+        "ldr    x0, [%[iter], #32] \n"
+        "ldr    x0, [x0] \n"
+        "str    x0, [%[iter], #32] \n"
+        "ldr    x1, [%[iter], #40] \n"
+        "ldr    x1, [x1] \n"
+        "str    x1, [%[iter], #40] \n"
+        "ldr    x2, [%[iter], #48] \n"
+        "ldr    x2, [x2] \n"
+        "str    x2, [%[iter], #48] \n"
+        "ldr    x3, [%[iter], #56] \n"
+        "ldr    x3, [x3] \n"
+        "str    x3, [%[iter], #56] \n"
+
+        "ldr    x0, [%[iter], #64] \n"
+        "ldr    x0, [x0] \n"
+        "str    x0, [%[iter], #64] \n"
+        "ldr    x1, [%[iter], #72] \n"
+        "ldr    x1, [x1] \n"
+        "str    x1, [%[iter], #72] \n"
+        "ldr    x2, [%[iter], #80] \n"
+        "ldr    x2, [x2] \n"
+        "str    x2, [%[iter], #80] \n"
+        "ldr    x3, [%[iter], #88] \n"
+        "ldr    x3, [x3] \n"
+        "str    x3, [%[iter], #88] \n"
+
+        "ldr    x0, [%[iter], #96] \n"
+        "ldr    x0, [x0] \n"
+        "str    x0, [%[iter], #96] \n"
+        "ldr    x1, [%[iter], #104] \n"
+        "ldr    x1, [x1] \n"
+        "str    x1, [%[iter], #104] \n"
+        "ldr    x2, [%[iter], #112] \n"
+        "ldr    x2, [x2] \n"
+        "str    x2, [%[iter], #112] \n"
+        "ldr    x3, [%[iter], #120] \n"
+        "ldr    x3, [x3] \n"
+        "str    x3, [%[iter], #120] \n"
+
+        "ldr    x0, [%[iter], #128] \n"
+        "ldr    x0, [x0] \n"
+        "str    x0, [%[iter], #128] \n"
+        "ldr    x1, [%[iter], #136] \n"
+        "ldr    x1, [x1] \n"
+        "str    x1, [%[iter], #136] \n"
+        "ldr    x2, [%[iter], #144] \n"
+        "ldr    x2, [x2] \n"
+        "str    x2, [%[iter], #144] \n"
+        "ldr    x3, [%[iter], #152] \n"
+        "ldr    x3, [x3] \n"
+        "str    x3, [%[iter], #152] \n"
+
+        "ldr    x0, [%[iter], #160] \n"
+        "ldr    x0, [x0] \n"
+        "str    x0, [%[iter], #160] \n"
+        "ldr    x1, [%[iter], #168] \n"
+        "ldr    x1, [x1] \n"
+        "str    x1, [%[iter], #168] \n"
+        "ldr    x2, [%[iter], #176] \n"
+        "ldr    x2, [x2] \n"
+        "str    x2, [%[iter], #176] \n"
+        "ldr    x3, [%[iter], #184] \n"
+        "ldr    x3, [x3] \n"
+        "str    x3, [%[iter], #184] \n"
+
+        "ldr    x0, [%[iter], #192] \n"
+        "ldr    x0, [x0] \n"
+        "str    x0, [%[iter], #192] \n"
+        "ldr    x1, [%[iter], #200] \n"
+        "ldr    x1, [x1] \n"
+        "str    x1, [%[iter], #200] \n"
+        "ldr    x2, [%[iter], #208] \n"
+        "ldr    x2, [x2] \n"
+        "str    x2, [%[iter], #208] \n"
+        "ldr    x3, [%[iter], #216] \n"
+        "ldr    x3, [x3] \n"
+        "str    x3, [%[iter], #216] \n"
+
+        "ldr    x0, [%[iter], #224] \n"
+        "ldr    x0, [x0] \n"
+        "str    x0, [%[iter], #224] \n"
+        "ldr    x1, [%[iter], #232] \n"
+        "ldr    x1, [x1] \n"
+        "str    x1, [%[iter], #232] \n"
+        "ldr    x2, [%[iter], #240] \n"
+        "ldr    x2, [x2] \n"
+        "str    x2, [%[iter], #240] \n"
+        "ldr    x3, [%[iter], #248] \n"
+        "ldr    x3, [x3] \n"
+        "str    x3, [%[iter], #248] \n"
+        // test read loop condition
+        "ldr    x0, [%[iter]] \n"
+        "cmp    x0, %[memarea] \n"      // compare chain 0 to its first iterator
+        "bne    2b \n"
+        // test repeat loop condition
+        "subs   %[repeats], %[repeats], #1 \n" // until repeats = 0
+        "bne    1b \n"
+        : [repeats] "+r" (repeats)
+        : [memarea] "r" (memarea), [iter] "r" (iter)
+        : "x0", "x1", "x2", "x3", "cc", "memory");
+}
+
+REGISTER_PERM_CHAINS(PermRead64Chain32Loop, 8, 32);
+
 // -----------------------------------------------------------------------------
@@ -9,6 +9,7 @@
  * 32/64/128/256 = size of access
  * Ptr = with pointer, Index = access as array[i]
  * Simple/Unroll = 1 or 16 operations per loop
+ * Skip = access one 64-bit word every g_stride bytes (option -k)
  *
  ******************************************************************************
  * Copyright (C) 2013 Timo Bingmann <tb@panthema.net>
@@ -73,6 +74,52 @@ void cScanWrite64IndexSimpleLoop(char* _memarea, size_t _size, size_t repeats)
 
 REGISTER(cScanWrite64IndexSimpleLoop, 8, 8, 1);
 
+// -----------------------------------------------------------------------------
+
+// 64-bit writer skipping forward g_stride bytes between accesses (C version)
+void cSkipWrite64PtrSimpleLoop(char* memarea, size_t size, size_t repeats)
+{
+    uint64_t* begin = (uint64_t*)memarea;
+    uint64_t* end = begin + size / sizeof(uint64_t);
+    size_t skip = g_stride / sizeof(uint64_t);
+    uint64_t value = 0xC0FFEEEEBABE0000;
+
+    do {
+        uint64_t* p = begin;
+        do {
+            *p = value;
+            p += skip;
+        }
+        while (p < end);
+    }
+    while (--repeats != 0);
+}
+
+REGISTER_STRIDE(cSkipWrite64PtrSimpleLoop, 8);
+
+// -----------------------------------------------------------------------------
+
+// 64-bit reader skipping forward g_stride bytes between accesses (C version),
+// volatile such that the compiler keeps the unused loads
+void cSkipRead64PtrSimpleLoop(char* memarea, size_t size, size_t repeats)
+{
+    const volatile uint64_t* begin = (const volatile uint64_t*)memarea;
+    const volatile uint64_t* end = begin + size / sizeof(uint64_t);
+    size_t skip = g_stride / sizeof(uint64_t);
+
+    do {
+        const volatile uint64_t* p = begin;
+        do {
+            *p;
+            p += skip;
+        }
+        while (p < end);
+    }
+    while (--repeats != 0);
+}
+
+REGISTER_STRIDE(cSkipRead64PtrSimpleLoop, 8);
+
 // ****************************************************************************
 // ----------------------------------------------------------------------------
 // 128-bit Operations
@@ -2,13 +2,18 @@
  * funcs_x86_64.h
  *
  * All Test Functions in 64-bit assembly code: they are codenamed as
- * Scan/Perm Read/Write 32/64/128/256 Ptr/Index Simple/Unroll Loop.
+ * Scan/Perm Read/Write 32/64/128/256/512 Ptr/Index Simple/Unroll Loop.
  *
  * Scan = consecutive scanning, Perm = walk permutation cycle.
  * Read/Write = obvious
- * 32/64/128/256 = size of access
+ * 32/64/128/256/512 = size of access
  * Ptr = with pointer, Index = access as array[i]
  * Simple/Unroll = 1 or 16 operations per loop
+ * NonTemporal = 16 streaming stores per loop, bypassing the cache
+ * Chain2..32 = walk 2 to 32 independent permutation cycles at once
+ * Skip = access one 64-bit word every g_stride bytes (option -k)
+ *
+ * Stream Copy/Scale/Add/Triad = the four STREAM kernels on two or three arrays
  *
  ******************************************************************************
  * Copyright (C) 2013 Timo Bingmann <tb@panthema.net>
@@ -113,6 +118,45 @@ void ScanWrite64PtrUnrollLoop(char* memarea, size_t size, size_t repeats)
 
 REGISTER(ScanWrite64PtrUnrollLoop, 8, 8, 16);
 
+// 64-bit writer in an unrolled loop with non-temporal stores (Assembler version)
+void ScanWrite64PtrNonTemporal(char* memarea, size_t size, size_t repeats)
+{
+    asm volatile(
+        "mov    $0xC0FFEEEEBABE0000, %%rax \n" // rax = test value
+        "1: \n" // start of repeat loop
+        "mov    %[memarea], %%rcx \n"   // rcx = reset loop iterator
+        "2: \n" // start of write loop
+        "movnti %%rax, 0*8(%%rcx) \n"
+        "movnti %%rax, 1*8(%%rcx) \n"
+        "movnti %%rax, 2*8(%%rcx) \n"
+        "movnti %%rax, 3*8(%%rcx) \n"
+        "movnti %%rax, 4*8(%%rcx) \n"
+        "movnti %%rax, 5*8(%%rcx) \n"
+        "movnti %%rax, 6*8(%%rcx) \n"
+        "movnti %%rax, 7*8(%%rcx) \n"
+        "movnti %%rax, 8*8(%%rcx) \n"
+        "movnti %%rax, 9*8(%%rcx) \n"
+        "movnti %%rax, 10*8(%%rcx) \n"
+        "movnti %%rax, 11*8(%%rcx) \n"
+        "movnti %%rax, 12*8(%%rcx) \n"
+        "movnti %%rax, 13*8(%%rcx) \n"
+        "movnti %%rax, 14*8(%%rcx) \n"
+        "movnti %%rax, 15*8(%%rcx) \n"
+        "add    $16*8, %%rcx \n"
+        // test write loop condition
+        "cmp    %[end], %%rcx \n"       // compare to end iterator
+        "jb     2b \n"
+        // test repeat loop condition
+        "dec    %[repeats] \n"          // until repeats = 0
+        "jnz    1b \n"
+        "sfence \n"                     // drain write-combining buffers
+        : [repeats] "+r" (repeats)
+        : [memarea] "r" (memarea), [end] "r" (memarea+size)
+        : "rax", "rcx", "cc", "memory");
+}
+
+REGISTER(ScanWrite64PtrNonTemporal, 8, 8, 16);
+
 // 64-bit reader in a simple loop (Assembler version)
 void ScanRead64PtrSimpleLoop(char* memarea, size_t size, size_t repeats)
 {
@@ -312,55 +356,73 @@ REGISTER(ScanRead64IndexUnrollLoop, 8, 8, 16);
 
 // -----------------------------------------------------------------------------
 
-#if 0
-static const int skiplen64 = 64; // one item per cache line
-
-// 64-bit skipping writer in a simple loop (C version)
+// 64-bit writer skipping forward g_stride bytes between accesses (C version)
 void cSkipWrite64PtrSimpleLoop(char* memarea, size_t size, size_t repeats)
 {
     uint64_t* begin = (uint64_t*)memarea;
     uint64_t* end = begin + size / sizeof(uint64_t);
+    size_t skip = g_stride / sizeof(uint64_t);
     uint64_t value = 0xC0FFEEEEBABE0000;
 
     do {
         uint64_t* p = begin;
         do {
-            *p++ = value;
-            p += skiplen64 / sizeof(uint64_t);
+            *p = value;
+            p += skip;
         }
         while (p < end);
     }
     while (--repeats != 0);
 }
 
-REGISTER(cSkipWrite64PtrSimpleLoop, 8, 8, 1);
+REGISTER_STRIDE(cSkipWrite64PtrSimpleLoop, 8);
 
-// 64-bit skipping writer in a simple loop (Assembler version)
+// 64-bit writer skipping forward g_stride bytes between accesses (Assembler
+// version)
 void SkipWrite64PtrSimpleLoop(char* memarea, size_t size, size_t repeats)
 {
     asm volatile(
         "mov    $0xC0FFEEEEBABE0000, %%rax \n" // rax = test value
-        "mov    %[memarea], %%rsi \n"   // rsi = memarea
-        "mov    %[size], %%rdi \n"
-        "add    %%rsi, %%rdi \n"        // rdi = memarea+size
         "1: \n" // start of repeat loop
-        "mov    %%rsi, %%rcx \n"        // rcx = reset loop iterator
+        "mov    %[memarea], %%rcx \n"   // rcx = reset loop iterator
         "2: \n" // start of write loop
         "mov    %%rax, (%%rcx) \n"
-        "add    $8, %%rcx \n"
+        "add    %[stride], %%rcx \n"
         // test write loop condition
-        "cmp    %%rdi, %%rcx \n"        // compare to end iterator
+        "cmp    %[end], %%rcx \n"       // compare to end iterator
+        "jb     2b \n"
+        // test repeat loop condition
+        "dec    %[repeats] \n"          // until repeats = 0
+        "jnz    1b \n"
+        : [repeats] "+r" (repeats)
+        : [memarea] "r" (memarea), [end] "r" (memarea+size), [stride] "r" (g_stride)
+        : "rax", "rcx", "cc", "memory");
+}
+
+REGISTER_STRIDE(SkipWrite64PtrSimpleLoop, 8);
+
+// 64-bit reader skipping forward g_stride bytes between accesses (Assembler
+// version)
+void SkipRead64PtrSimpleLoop(char* memarea, size_t size, size_t repeats)
+{
+    asm volatile(
+        "1: \n" // start of repeat loop
+        "mov    %[memarea], %%rcx \n"   // rcx = reset loop iterator
+        "2: \n" // start of read loop
+        "mov    (%%rcx), %%rax \n"
+        "add    %[stride], %%rcx \n"
+        // test read loop condition
+        "cmp    %[end], %%rcx \n"       // compare to end iterator
         "jb     2b \n"
         // test repeat loop condition
         "dec    %[repeats] \n"          // until repeats = 0
         "jnz    1b \n"
         : [repeats] "+r" (repeats)
-        : [memarea] "g" (memarea), [size] "g" (size)
-        : "rax", "rcx", "rsi", "rdi", "cc", "memory");
+        : [memarea] "r" (memarea), [end] "r" (memarea+size), [stride] "r" (g_stride)
+        : "rax", "rcx", "cc", "memory");
 }
 
-REGISTER(SkipWrite64PtrSimpleLoop, 8, 8, 1);
-#endif
+REGISTER_STRIDE(SkipRead64PtrSimpleLoop, 8);
 
 // ****************************************************************************
 // ----------------------------------------------------------------------------
@@ -457,6 +519,48 @@ void ScanWrite128PtrUnrollLoop(char* memarea, size_t size, size_t repeats)
 
 REGISTER_CPUFEAT(ScanWrite128PtrUnrollLoop, "sse", 16, 16, 16);
 
+// 128-bit writer in an unrolled loop with non-temporal stores (Assembler version)
+void ScanWrite128PtrNonTemporal(char* memarea, size_t size, size_t repeats)
+{
+    asm volatile(
+        "mov    $0xC0FFEEEEBABE0000, %%rax \n"
+        "movq   %%rax, %%xmm0 \n"
+        "movq   %%rax, %%xmm1 \n"
+        "movlhps %%xmm0, %%xmm1 \n"     // xmm0 = test value
+        "1: \n" // start of repeat loop
+        "mov    %[memarea], %%rax \n"   // rax = reset loop iterator
+        "2: \n" // start of write loop
+        "movntdq %%xmm0, 0*16(%%rax) \n"
+        "movntdq %%xmm0, 1*16(%%rax) \n"
+        "movntdq %%xmm0, 2*16(%%rax) \n"
+        "movntdq %%xmm0, 3*16(%%rax) \n"
+        "movntdq %%xmm0, 4*16(%%rax) \n"
+        "movntdq %%xmm0, 5*16(%%rax) \n"
+        "movntdq %%xmm0, 6*16(%%rax) \n"
+        "movntdq %%xmm0, 7*16(%%rax) \n"
+        "movntdq %%xmm0, 8*16(%%rax) \n"
+        "movntdq %%xmm0, 9*16(%%rax) \n"
+        "movntdq %%xmm0, 10*16(%%rax) \n"
+        "movntdq %%xmm0, 11*16(%%rax) \n"
+        "movntdq %%xmm0, 12*16(%%rax) \n"
+        "movntdq %%xmm0, 13*16(%%rax) \n"
+        "movntdq %%xmm0, 14*16(%%rax) \n"
+        "movntdq %%xmm0, 15*16(%%rax) \n"
+        "add    $16*16, %%rax \n"
+        // test write loop condition
+        "cmp    %[end], %%rax \n"       // compare to end iterator
+        "jb     2b \n"
+        // test repeat loop condition
+        "dec    %[repeats] \n"          // until repeats = 0
+        "jnz    1b \n"
+        "sfence \n"                     // drain write-combining buffers
+        : [repeats] "+r" (repeats)
+        : [memarea] "r" (memarea), [end] "r" (memarea+size)
+        : "rax", "xmm0", "xmm1", "cc", "memory");
+}
+
+REGISTER_CPUFEAT(ScanWrite128PtrNonTemporal, "sse", 16, 16, 16);
+
 // 128-bit reader in a simple loop (Assembler version)
 void ScanRead128PtrSimpleLoop(char* memarea, size_t size, size_t repeats)
 {
@@ -589,6 +693,48 @@ void ScanWrite256PtrUnrollLoop(char* memarea, size_t size, size_t repeats)
 
 REGISTER_CPUFEAT(ScanWrite256PtrUnrollLoop, "avx", 32, 32, 16);
 
+// 256-bit writer in an unrolled loop with non-temporal stores (Assembler version)
+void ScanWrite256PtrNonTemporal(char* memarea, size_t size, size_t repeats)
+{
+    uint64_t value = 0xC0FFEEEEBABE0000;
+
+    asm volatile(
+        "vbroadcastsd %[value], %%ymm0 \n" // ymm0 = test value
+        "1: \n" // start of repeat loop
+        "mov    %[memarea], %%rax \n"   // rax = reset loop iterator
+        "2: \n" // start of write loop
+        "vmovntdq %%ymm0, 0*32(%%rax) \n"
+        "vmovntdq %%ymm0, 1*32(%%rax) \n"
+        "vmovntdq %%ymm0, 2*32(%%rax) \n"
+        "vmovntdq %%ymm0, 3*32(%%rax) \n"
+        "vmovntdq %%ymm0, 4*32(%%rax) \n"
+        "vmovntdq %%ymm0, 5*32(%%rax) \n"
+        "vmovntdq %%ymm0, 6*32(%%rax) \n"
+        "vmovntdq %%ymm0, 7*32(%%rax) \n"
+        "vmovntdq %%ymm0, 8*32(%%rax) \n"
+        "vmovntdq %%ymm0, 9*32(%%rax) \n"
+        "vmovntdq %%ymm0, 10*32(%%rax) \n"
+        "vmovntdq %%ymm0, 11*32(%%rax) \n"
+        "vmovntdq %%ymm0, 12*32(%%rax) \n"
+        "vmovntdq %%ymm0, 13*32(%%rax) \n"
+        "vmovntdq %%ymm0, 14*32(%%rax) \n"
+        "vmovntdq %%ymm0, 15*32(%%rax) \n"
+        "add    $16*32, %%rax \n"
+        // test write loop condition
+        "cmp    %[end], %%rax \n"       // compare to end iterator
+        "jb     2b \n"
+        // test repeat loop condition
+        "dec    %[repeats] \n"          // until repeats = 0
+        "jnz    1b \n"
+        "sfence \n"                     // drain write-combining buffers
+        : [repeats] "+r" (repeats)
+        : [memarea] "r" (memarea), [end] "r" (memarea+size),
+          [value] "m" (value)
+        : "rax", "xmm0", "cc", "memory");
+}
+
+REGISTER_CPUFEAT(ScanWrite256PtrNonTemporal, "avx", 32, 32, 16);
+
 // 256-bit reader in a simple loop (Assembler version)
 void ScanRead256PtrSimpleLoop(char* memarea, size_t size, size_t repeats)
 {
@@ -648,6 +794,479 @@ void ScanRead256PtrUnrollLoop(char* memarea, size_t size, size_t repeats)
 
 REGISTER_CPUFEAT(ScanRead256PtrUnrollLoop, "avx", 32, 32, 16);
 
+// ****************************************************************************
+// ----------------------------------------------------------------------------
+// 512-bit Operations
+// ----------------------------------------------------------------------------
+// ****************************************************************************
+
+// 512-bit writer in a simple loop (Assembler version)
+void ScanWrite512PtrSimpleLoop(char* memarea, size_t size, size_t repeats)
+{
+    uint64_t value = 0xC0FFEEEEBABE0000;
+
+    asm volatile(
+        "vpbroadcastq %[value], %%zmm0 \n" // zmm0 = test value
+        "1: \n" // start of repeat loop
+        "mov    %[memarea], %%rax \n"   // rax = reset loop iterator
+        "2: \n" // start of write loop
+        "vmovdqa64 %%zmm0, (%%rax) \n"
+        "add    $64, %%rax \n"
+        // test write loop condition
+        "cmp    %[end], %%rax \n"       // compare to end iterator
+        "jb     2b \n"
+        // test repeat loop condition
+        "dec    %[repeats] \n"          // until repeats = 0
+        "jnz    1b \n"
+        "vzeroupper \n"             // avoid AVX-SSE transition penalty
+        : [repeats] "+r" (repeats)
+        : [memarea] "r" (memarea), [end] "r" (memarea+size),
+          [value] "m" (value)
+        : "rax", "xmm0", "cc", "memory");
+}
+
+REGISTER_CPUFEAT(ScanWrite512PtrSimpleLoop, "avx512f", 64, 64, 1);
+
+// 512-bit writer in an unrolled loop (Assembler version)
+void ScanWrite512PtrUnrollLoop(char* memarea, size_t size, size_t repeats)
+{
+    uint64_t value = 0xC0FFEEEEBABE0000;
+
+    asm volatile(
+        "vpbroadcastq %[value], %%zmm0 \n" // zmm0 = test value
+        "1: \n" // start of repeat loop
+        "mov    %[memarea], %%rax \n"   // rax = reset loop iterator
+        "2: \n" // start of write loop
+        "vmovdqa64 %%zmm0, 0*64(%%rax) \n"
+        "vmovdqa64 %%zmm0, 1*64(%%rax) \n"
+        "vmovdqa64 %%zmm0, 2*64(%%rax) \n"
+        "vmovdqa64 %%zmm0, 3*64(%%rax) \n"
+        "vmovdqa64 %%zmm0, 4*64(%%rax) \n"
+        "vmovdqa64 %%zmm0, 5*64(%%rax) \n"
+        "vmovdqa64 %%zmm0, 6*64(%%rax) \n"
+        "vmovdqa64 %%zmm0, 7*64(%%rax) \n"
+        "vmovdqa64 %%zmm0, 8*64(%%rax) \n"
+        "vmovdqa64 %%zmm0, 9*64(%%rax) \n"
+        "vmovdqa64 %%zmm0, 10*64(%%rax) \n"
+        "vmovdqa64 %%zmm0, 11*64(%%rax) \n"
+        "vmovdqa64 %%zmm0, 12*64(%%rax) \n"
+        "vmovdqa64 %%zmm0, 13*64(%%rax) \n"
+        "vmovdqa64 %%zmm0, 14*64(%%rax) \n"
+        "vmovdqa64 %%zmm0, 15*64(%%rax) \n"
+        "add    $16*64, %%rax \n"
+        // test write loop condition
+        "cmp    %[end], %%rax \n"       // compare to end iterator
+        "jb     2b \n"
+        // test repeat loop condition
+        "dec    %[repeats] \n"          // until repeats = 0
+        "jnz    1b \n"
+        "vzeroupper \n"             // avoid AVX-SSE transition penalty
+        : [repeats] "+r" (repeats)
+        : [memarea] "r" (memarea), [end] "r" (memarea+size),
+          [value] "m" (value)
+        : "rax", "xmm0", "cc", "memory");
+}
+
+REGISTER_CPUFEAT(ScanWrite512PtrUnrollLoop, "avx512f", 64, 64, 16);
+
+// 512-bit writer in an unrolled loop with non-temporal stores (Assembler version)
+void ScanWrite512PtrNonTemporal(char* memarea, size_t size, size_t repeats)
+{
+    uint64_t value = 0xC0FFEEEEBABE0000;
+
+    asm volatile(
+        "vpbroadcastq %[value], %%zmm0 \n" // zmm0 = test value
+        "1: \n" // start of repeat loop
+        "mov    %[memarea], %%rax \n"   // rax = reset loop iterator
+        "2: \n" // start of write loop
+        "vmovntdq %%zmm0, 0*64(%%rax) \n"
+        "vmovntdq %%zmm0, 1*64(%%rax) \n"
+        "vmovntdq %%zmm0, 2*64(%%rax) \n"
+        "vmovntdq %%zmm0, 3*64(%%rax) \n"
+        "vmovntdq %%zmm0, 4*64(%%rax) \n"
+        "vmovntdq %%zmm0, 5*64(%%rax) \n"
+        "vmovntdq %%zmm0, 6*64(%%rax) \n"
+        "vmovntdq %%zmm0, 7*64(%%rax) \n"
+        "vmovntdq %%zmm0, 8*64(%%rax) \n"
+        "vmovntdq %%zmm0, 9*64(%%rax) \n"
+        "vmovntdq %%zmm0, 10*64(%%rax) \n"
+        "vmovntdq %%zmm0, 11*64(%%rax) \n"
+        "vmovntdq %%zmm0, 12*64(%%rax) \n"
+        "vmovntdq %%zmm0, 13*64(%%rax) \n"
+        "vmovntdq %%zmm0, 14*64(%%rax) \n"
+        "vmovntdq %%zmm0, 15*64(%%rax) \n"
+        "add    $16*64, %%rax \n"
+        // test write loop condition
+        "cmp    %[end], %%rax \n"       // compare to end iterator
+        "jb     2b \n"
+        // test repeat loop condition
+        "dec    %[repeats] \n"          // until repeats = 0
+        "jnz    1b \n"
+        "sfence \n"                     // drain write-combining buffers
+        "vzeroupper \n"             // avoid AVX-SSE transition penalty
+        : [repeats] "+r" (repeats)
+        : [memarea] "r" (memarea), [end] "r" (memarea+size),
+          [value] "m" (value)
+        : "rax", "xmm0", "cc", "memory");
+}
+
+REGISTER_CPUFEAT(ScanWrite512PtrNonTemporal, "avx512f", 64, 64, 16);
+
+// 512-bit reader in a simple loop (Assembler version)
+void ScanRead512PtrSimpleLoop(char* memarea, size_t size, size_t repeats)
+{
+    asm volatile(
+        "1: \n" // start of repeat loop
+        "mov    %[memarea], %%rax \n"   // rax = reset loop iterator
+        "2: \n" // start of read loop
+        "vmovdqa64 (%%rax), %%zmm0 \n"
+        "add    $64, %%rax \n"
+        // test read loop condition
+        "cmp    %[end], %%rax \n"       // compare to end iterator
+        "jb     2b \n"
+        // test repeat loop condition
+        "dec    %[repeats] \n"          // until repeats = 0
+        "jnz    1b \n"
+        "vzeroupper \n"             // avoid AVX-SSE transition penalty
+        : [repeats] "+r" (repeats)
+        : [memarea] "r" (memarea), [end] "r" (memarea+size)
+        : "rax", "xmm0", "cc", "memory");
+}
+
+REGISTER_CPUFEAT(ScanRead512PtrSimpleLoop, "avx512f", 64, 64, 1);
+
+// 512-bit reader in an unrolled loop (Assembler version)
+void ScanRead512PtrUnrollLoop(char* memarea, size_t size, size_t repeats)
+{
+    asm volatile(
+        "1: \n" // start of repeat loop
+        "mov    %[memarea], %%rax \n"   // rax = reset loop iterator
+        "2: \n" // start of read loop
+        "vmovdqa64 0*64(%%rax), %%zmm0 \n"
+        "vmovdqa64 1*64(%%rax), %%zmm0 \n"
+        "vmovdqa64 2*64(%%rax), %%zmm0 \n"
+        "vmovdqa64 3*64(%%rax), %%zmm0 \n"
+        "vmovdqa64 4*64(%%rax), %%zmm0 \n"
+        "vmovdqa64 5*64(%%rax), %%zmm0 \n"
+        "vmovdqa64 6*64(%%rax), %%zmm0 \n"
+        "vmovdqa64 7*64(%%rax), %%zmm0 \n"
+        "vmovdqa64 8*64(%%rax), %%zmm0 \n"
+        "vmovdqa64 9*64(%%rax), %%zmm0 \n"
+        "vmovdqa64 10*64(%%rax), %%zmm0 \n"
+        "vmovdqa64 11*64(%%rax), %%zmm0 \n"
+        "vmovdqa64 12*64(%%rax), %%zmm0 \n"
+        "vmovdqa64 13*64(%%rax), %%zmm0 \n"
+        "vmovdqa64 14*64(%%rax), %%zmm0 \n"
+        "vmovdqa64 15*64(%%rax), %%zmm0 \n"
+        "add    $16*64, %%rax \n"
+        // test read loop condition
+        "cmp    %[end], %%rax \n"       // compare to end iterator
+        "jb     2b \n"
+        // test repeat loop condition
+        "dec    %[repeats] \n"          // until repeats = 0
+        "jnz    1b \n"
+        "vzeroupper \n"             // avoid AVX-SSE transition penalty
+        : [repeats] "+r" (repeats)
+        : [memarea] "r" (memarea), [end] "r" (memarea+size)
+        : "rax", "xmm0", "cc", "memory");
+}
+
+REGISTER_CPUFEAT(ScanRead512PtrUnrollLoop, "avx512f", 64, 64, 16);
+
+// ****************************************************************************
+// ----------------------------------------------------------------------------
+// Multi-Array Operations (STREAM Copy, Scale, Add and Triad on doubles)
+// ----------------------------------------------------------------------------
+// ****************************************************************************
+
+// 128-bit STREAM Copy b[i] = a[i] in an unrolled loop (Assembler version)
+void StreamCopy128PtrUnrollLoop(char* memarea, size_t size, size_t repeats)
+{
+    asm volatile(
+        "1: \n" // start of repeat loop
+        "xor    %%rcx, %%rcx \n"        // rcx = reset index
+        "2: \n" // start of array loop
+        "movapd 0*16(%[a],%%rcx), %%xmm0 \n"
+        "movapd 1*16(%[a],%%rcx), %%xmm1 \n"
+        "movapd 2*16(%[a],%%rcx), %%xmm2 \n"
+        "movapd 3*16(%[a],%%rcx), %%xmm3 \n"
+        "movapd %%xmm0, 0*16(%[b],%%rcx) \n"
+        "movapd %%xmm1, 1*16(%[b],%%rcx) \n"
+        "movapd %%xmm2, 2*16(%[b],%%rcx) \n"
+        "movapd %%xmm3, 3*16(%[b],%%rcx) \n"
+        "add    $4*16, %%rcx \n"
+        // test array loop condition
+        "cmp    %[size], %%rcx \n"      // compare to array size
+        "jb     2b \n"
+        // test repeat loop condition
+        "dec    %[repeats] \n"          // until repeats = 0
+        "jnz    1b \n"
+        : [repeats] "+r" (repeats)
+        : [a] "r" (memarea), [b] "r" (memarea+size), [size] "r" (size)
+        : "rcx", "xmm0", "xmm1", "xmm2", "xmm3", "cc", "memory");
+}
+
+REGISTER_STREAMS(StreamCopy128PtrUnrollLoop, "sse", 16, 4, 2);
+
+// 128-bit STREAM Scale b[i] = scalar * a[i] in an unrolled loop (Assembler version)
+void StreamScale128PtrUnrollLoop(char* memarea, size_t size, size_t repeats)
+{
+    double scalar = 3.0;
+
+    asm volatile(
+        "movsd  %[scalar], %%xmm4 \n"
+        "unpcklpd %%xmm4, %%xmm4 \n"    // xmm4 = scalar in both lanes
+        "1: \n" // start of repeat loop
+        "xor    %%rcx, %%rcx \n"        // rcx = reset index
+        "2: \n" // start of array loop
+        "movapd 0*16(%[a],%%rcx), %%xmm0 \n"
+        "movapd 1*16(%[a],%%rcx), %%xmm1 \n"
+        "movapd 2*16(%[a],%%rcx), %%xmm2 \n"
+        "movapd 3*16(%[a],%%rcx), %%xmm3 \n"
+        "mulpd  %%xmm4, %%xmm0 \n"
+        "mulpd  %%xmm4, %%xmm1 \n"
+        "mulpd  %%xmm4, %%xmm2 \n"
+        "mulpd  %%xmm4, %%xmm3 \n"
+        "movapd %%xmm0, 0*16(%[b],%%rcx) \n"
+        "movapd %%xmm1, 1*16(%[b],%%rcx) \n"
+        "movapd %%xmm2, 2*16(%[b],%%rcx) \n"
+        "movapd %%xmm3, 3*16(%[b],%%rcx) \n"
+        "add    $4*16, %%rcx \n"
+        // test array loop condition
+        "cmp    %[size], %%rcx \n"      // compare to array size
+        "jb     2b \n"
+        // test repeat loop condition
+        "dec    %[repeats] \n"          // until repeats = 0
+        "jnz    1b \n"
+        : [repeats] "+r" (repeats)
+        : [a] "r" (memarea), [b] "r" (memarea+size), [size] "r" (size),
+          [scalar] "m" (scalar)
+        : "rcx", "xmm0", "xmm1", "xmm2", "xmm3", "xmm4", "cc", "memory");
+}
+
+REGISTER_STREAMS(StreamScale128PtrUnrollLoop, "sse", 16, 4, 2);
+
+// 128-bit STREAM Add c[i] = a[i] + b[i] in an unrolled loop (Assembler version)
+void StreamAdd128PtrUnrollLoop(char* memarea, size_t size, size_t repeats)
+{
+    asm volatile(
+        "1: \n" // start of repeat loop
+        "xor    %%rcx, %%rcx \n"        // rcx = reset index
+        "2: \n" // start of array loop
+        "movapd 0*16(%[a],%%rcx), %%xmm0 \n"
+        "movapd 1*16(%[a],%%rcx), %%xmm1 \n"
+        "movapd 2*16(%[a],%%rcx), %%xmm2 \n"
+        "movapd 3*16(%[a],%%rcx), %%xmm3 \n"
+        "addpd  0*16(%[b],%%rcx), %%xmm0 \n"
+        "addpd  1*16(%[b],%%rcx), %%xmm1 \n"
+        "addpd  2*16(%[b],%%rcx), %%xmm2 \n"
+        "addpd  3*16(%[b],%%rcx), %%xmm3 \n"
+        "movapd %%xmm0, 0*16(%[c],%%rcx) \n"
+        "movapd %%xmm1, 1*16(%[c],%%rcx) \n"
+        "movapd %%xmm2, 2*16(%[c],%%rcx) \n"
+        "movapd %%xmm3, 3*16(%[c],%%rcx) \n"
+        "add    $4*16, %%rcx \n"
+        // test array loop condition
+        "cmp    %[size], %%rcx \n"      // compare to array size
+        "jb     2b \n"
+        // test repeat loop condition
+        "dec    %[repeats] \n"          // until repeats = 0
+        "jnz    1b \n"
+        : [repeats] "+r" (repeats)
+        : [a] "r" (memarea), [b] "r" (memarea+size), [c] "r" (memarea+2*size),
+          [size] "r" (size)
+        : "rcx", "xmm0", "xmm1", "xmm2", "xmm3", "cc", "memory");
+}
+
+REGISTER_STREAMS(StreamAdd128PtrUnrollLoop, "sse", 16, 4, 3);
+
+// 128-bit STREAM Triad a[i] = b[i] + scalar * c[i] in an unrolled loop (Assembler version)
+void StreamTriad128PtrUnrollLoop(char* memarea, size_t size, size_t repeats)
+{
+    double scalar = 3.0;
+
+    asm volatile(
+        "movsd  %[scalar], %%xmm4 \n"
+        "unpcklpd %%xmm4, %%xmm4 \n"    // xmm4 = scalar in both lanes
+        "1: \n" // start of repeat loop
+        "xor    %%rcx, %%rcx \n"        // rcx = reset index
+        "2: \n" // start of array loop
+        "movapd 0*16(%[c],%%rcx), %%xmm0 \n"
+        "movapd 1*16(%[c],%%rcx), %%xmm1 \n"
+        "movapd 2*16(%[c],%%rcx), %%xmm2 \n"
+        "movapd 3*16(%[c],%%rcx), %%xmm3 \n"
+        "mulpd  %%xmm4, %%xmm0 \n"
+        "mulpd  %%xmm4, %%xmm1 \n"
+        "mulpd  %%xmm4, %%xmm2 \n"
+        "mulpd  %%xmm4, %%xmm3 \n"
+        "addpd  0*16(%[b],%%rcx), %%xmm0 \n"
+        "addpd  1*16(%[b],%%rcx), %%xmm1 \n"
+        "addpd  2*16(%[b],%%rcx), %%xmm2 \n"
+        "addpd  3*16(%[b],%%rcx), %%xmm3 \n"
+        "movapd %%xmm0, 0*16(%[a],%%rcx) \n"
+        "movapd %%xmm1, 1*16(%[a],%%rcx) \n"
+        "movapd %%xmm2, 2*16(%[a],%%rcx) \n"
+        "movapd %%xmm3, 3*16(%[a],%%rcx) \n"
+        "add    $4*16, %%rcx \n"
+        // test array loop condition
+        "cmp    %[size], %%rcx \n"      // compare to array size
+        "jb     2b \n"
+        // test repeat loop condition
+        "dec    %[repeats] \n"          // until repeats = 0
+        "jnz    1b \n"
+        : [repeats] "+r" (repeats)
+        : [a] "r" (memarea), [b] "r" (memarea+size), [c] "r" (memarea+2*size),
+          [size] "r" (size), [scalar] "m" (scalar)
+        : "rcx", "xmm0", "xmm1", "xmm2", "xmm3", "xmm4", "cc", "memory");
+}
+
+REGISTER_STREAMS(StreamTriad128PtrUnrollLoop, "sse", 16, 4, 3);
+
+// 256-bit STREAM Copy b[i] = a[i] in an unrolled loop (Assembler version)
+void StreamCopy256PtrUnrollLoop(char* memarea, size_t size, size_t repeats)
+{
+    asm volatile(
+        "1: \n" // start of repeat loop
+        "xor    %%rcx, %%rcx \n"        // rcx = reset index
+        "2: \n" // start of array loop
+        "vmovapd 0*32(%[a],%%rcx), %%ymm0 \n"
+        "vmovapd 1*32(%[a],%%rcx), %%ymm1 \n"
+        "vmovapd 2*32(%[a],%%rcx), %%ymm2 \n"
+        "vmovapd 3*32(%[a],%%rcx), %%ymm3 \n"
+        "vmovapd %%ymm0, 0*32(%[b],%%rcx) \n"
+        "vmovapd %%ymm1, 1*32(%[b],%%rcx) \n"
+        "vmovapd %%ymm2, 2*32(%[b],%%rcx) \n"
+        "vmovapd %%ymm3, 3*32(%[b],%%rcx) \n"
+        "add    $4*32, %%rcx \n"
+        // test array loop condition
+        "cmp    %[size], %%rcx \n"      // compare to array size
+        "jb     2b \n"
+        // test repeat loop condition
+        "dec    %[repeats] \n"          // until repeats = 0
+        "jnz    1b \n"
+        "vzeroupper \n"             // avoid AVX-SSE transition penalty
+        : [repeats] "+r" (repeats)
+        : [a] "r" (memarea), [b] "r" (memarea+size), [size] "r" (size)
+        : "rcx", "xmm0", "xmm1", "xmm2", "xmm3", "cc", "memory");
+}
+
+REGISTER_STREAMS(StreamCopy256PtrUnrollLoop, "avx", 32, 4, 2);
+
+// 256-bit STREAM Scale b[i] = scalar * a[i] in an unrolled loop (Assembler version)
+void StreamScale256PtrUnrollLoop(char* memarea, size_t size, size_t repeats)
+{
+    double scalar = 3.0;
+
+    asm volatile(
+        "vbroadcastsd %[scalar], %%ymm4 \n" // ymm4 = scalar in all lanes
+        "1: \n" // start of repeat loop
+        "xor    %%rcx, %%rcx \n"        // rcx = reset index
+        "2: \n" // start of array loop
+        "vmovapd 0*32(%[a],%%rcx), %%ymm0 \n"
+        "vmovapd 1*32(%[a],%%rcx), %%ymm1 \n"
+        "vmovapd 2*32(%[a],%%rcx), %%ymm2 \n"
+        "vmovapd 3*32(%[a],%%rcx), %%ymm3 \n"
+        "vmulpd %%ymm4, %%ymm0, %%ymm0 \n"
+        "vmulpd %%ymm4, %%ymm1, %%ymm1 \n"
+        "vmulpd %%ymm4, %%ymm2, %%ymm2 \n"
+        "vmulpd %%ymm4, %%ymm3, %%ymm3 \n"
+        "vmovapd %%ymm0, 0*32(%[b],%%rcx) \n"
+        "vmovapd %%ymm1, 1*32(%[b],%%rcx) \n"
+        "vmovapd %%ymm2, 2*32(%[b],%%rcx) \n"
+        "vmovapd %%ymm3, 3*32(%[b],%%rcx) \n"
+        "add    $4*32, %%rcx \n"
+        // test array loop condition
+        "cmp    %[size], %%rcx \n"      // compare to array size
+        "jb     2b \n"
+        // test repeat loop condition
+        "dec    %[repeats] \n"          // until repeats = 0
+        "jnz    1b \n"
+        "vzeroupper \n"             // avoid AVX-SSE transition penalty
+        : [repeats] "+r" (repeats)
+        : [a] "r" (memarea), [b] "r" (memarea+size), [size] "r" (size),
+          [scalar] "m" (scalar)
+        : "rcx", "xmm0", "xmm1", "xmm2", "xmm3", "xmm4", "cc", "memory");
+}
+
+REGISTER_STREAMS(StreamScale256PtrUnrollLoop, "avx", 32, 4, 2);
+
+// 256-bit STREAM Add c[i] = a[i] + b[i] in an unrolled loop (Assembler version)
+void StreamAdd256PtrUnrollLoop(char* memarea, size_t size, size_t repeats)
+{
+    asm volatile(
+        "1: \n" // start of repeat loop
+        "xor    %%rcx, %%rcx \n"        // rcx = reset index
+        "2: \n" // start of array loop
+        "vmovapd 0*32(%[a],%%rcx), %%ymm0 \n"
+        "vmovapd 1*32(%[a],%%rcx), %%ymm1 \n"
+        "vmovapd 2*32(%[a],%%rcx), %%ymm2 \n"
+        "vmovapd 3*32(%[a],%%rcx), %%ymm3 \n"
+        "vaddpd 0*32(%[b],%%rcx), %%ymm0, %%ymm0 \n"
+        "vaddpd 1*32(%[b],%%rcx), %%ymm1, %%ymm1 \n"
+        "vaddpd 2*32(%[b],%%rcx), %%ymm2, %%ymm2 \n"
+        "vaddpd 3*32(%[b],%%rcx), %%ymm3, %%ymm3 \n"
+        "vmovapd %%ymm0, 0*32(%[c],%%rcx) \n"
+        "vmovapd %%ymm1, 1*32(%[c],%%rcx) \n"
+        "vmovapd %%ymm2, 2*32(%[c],%%rcx) \n"
+        "vmovapd %%ymm3, 3*32(%[c],%%rcx) \n"
+        "add    $4*32, %%rcx \n"
+        // test array loop condition
+        "cmp    %[size], %%rcx \n"      // compare to array size
+        "jb     2b \n"
+        // test repeat loop condition
+        "dec    %[repeats] \n"          // until repeats = 0
+        "jnz    1b \n"
+        "vzeroupper \n"             // avoid AVX-SSE transition penalty
+        : [repeats] "+r" (repeats)
+        : [a] "r" (memarea), [b] "r" (memarea+size), [c] "r" (memarea+2*size),
+          [size] "r" (size)
+        : "rcx", "xmm0", "xmm1", "xmm2", "xmm3", "cc", "memory");
+}
+
+REGISTER_STREAMS(StreamAdd256PtrUnrollLoop, "avx", 32, 4, 3);
+
+// 256-bit STREAM Triad a[i] = b[i] + scalar * c[i] in an unrolled loop (Assembler version)
+void StreamTriad256PtrUnrollLoop(char* memarea, size_t size, size_t repeats)
+{
+    double scalar = 3.0;
+
+    asm volatile(
+        "vbroadcastsd %[scalar], %%ymm4 \n" // ymm4 = scalar in all lanes
+        "1: \n" // start of repeat loop
+        "xor    %%rcx, %%rcx \n"        // rcx = reset index
+        "2: \n" // start of array loop
+        "vmovapd 0*32(%[c],%%rcx), %%ymm0 \n"
+        "vmovapd 1*32(%[c],%%rcx), %%ymm1 \n"
+        "vmovapd 2*32(%[c],%%rcx), %%ymm2 \n"
+        "vmovapd 3*32(%[c],%%rcx), %%ymm3 \n"
+        "vmulpd %%ymm4, %%ymm0, %%ymm0 \n"
+        "vmulpd %%ymm4, %%ymm1, %%ymm1 \n"
+        "vmulpd %%ymm4, %%ymm2, %%ymm2 \n"
+        "vmulpd %%ymm4, %%ymm3, %%ymm3 \n"
+        "vaddpd 0*32(%[b],%%rcx), %%ymm0, %%ymm0 \n"
+        "vaddpd 1*32(%[b],%%rcx), %%ymm1, %%ymm1 \n"
+        "vaddpd 2*32(%[b],%%rcx), %%ymm2, %%ymm2 \n"
+        "vaddpd 3*32(%[b],%%rcx), %%ymm3, %%ymm3 \n"
+        "vmovapd %%ymm0, 0*32(%[a],%%rcx) \n"
+        "vmovapd %%ymm1, 1*32(%[a],%%rcx) \n"
+        "vmovapd %%ymm2, 2*32(%[a],%%rcx) \n"
+        "vmovapd %%ymm3, 3*32(%[a],%%rcx) \n"
+        "add    $4*32, %%rcx \n"
+        // test array loop condition
+        "cmp    %[size], %%rcx \n"      // compare to array size
+        "jb     2b \n"
+        // test repeat loop condition
+        "dec    %[repeats] \n"          // until repeats = 0
+        "jnz    1b \n"
+        "vzeroupper \n"             // avoid AVX-SSE transition penalty
+        : [repeats] "+r" (repeats)
+        : [a] "r" (memarea), [b] "r" (memarea+size), [c] "r" (memarea+2*size),
+          [size] "r" (size), [scalar] "m" (scalar)
+        : "rcx", "xmm0", "xmm1", "xmm2", "xmm3", "xmm4", "cc", "memory");
+}
+
+REGISTER_STREAMS(StreamTriad256PtrUnrollLoop, "avx", 32, 4, 3);
+
 // ****************************************************************************
 // ----------------------------------------------------------------------------
 // 32-bit Operations
@@ -857,4 +1476,291 @@ void PermRead64UnrollLoop(char* memarea, size_t, size_t repeats)
 
 REGISTER_PERM(PermRead64UnrollLoop, 8);
 
+// follow 2 independent 64-bit permutation cycles at once (Assembler version)
+void PermRead64Chain2Loop(char* memarea, size_t, size_t repeats)
+{
+    asm volatile(
+        "mov    %[memarea], %%rax \n"   // rax = iterator of chain 0
+        "lea    64(%[memarea]), %%rcx \n"
+        "1: \n" // start of repeat loop
+        "2: \n" // start of read loop
+        "mov    (%%rax), %%rax \n"
+        "mov    (%%rcx), %%rcx \n"
+        // test read loop condition
+        "cmp    %%rax, %[memarea] \n"   // compare chain 0 to its first iterator
+        "jne    2b \n"
+        // test repeat loop condition
+        "dec    %[repeats] \n"          // until repeats = 0
+        "jnz    1b \n"
+        : [repeats] "+r" (repeats)
+        : [memarea] "r" (memarea)
+        : "rax", "rcx", "cc", "memory");
+}
+
+REGISTER_PERM_CHAINS(PermRead64Chain2Loop, 8, 2);
+
+// follow 4 independent 64-bit permutation cycles at once (Assembler version)
+void PermRead64Chain4Loop(char* memarea, size_t, size_t repeats)
+{
+    asm volatile(
+        "mov    %[memarea], %%rax \n"   // rax = iterator of chain 0
+        "lea    64(%[memarea]), %%rcx \n"
+        "lea    128(%[memarea]), %%rdx \n"
+        "lea    192(%[memarea]), %%rsi \n"
+        "1: \n" // start of repeat loop
+        "2: \n" // start of read loop
+        "mov    (%%rax), %%rax \n"
+        "mov    (%%rcx), %%rcx \n"
+        "mov    (%%rdx), %%rdx \n"
+        "mov    (%%rsi), %%rsi \n"
+        // test read loop condition
+        "cmp    %%rax, %[memarea] \n"   // compare chain 0 to its first iterator
+        "jne    2b \n"
+        // test repeat loop condition
+        "dec    %[repeats] \n"          // until repeats = 0
+        "jnz    1b \n"
+        : [repeats] "+r" (repeats)
+        : [memarea] "r" (memarea)
+        : "rax", "rcx", "rdx", "rsi", "cc", "memory");
+}
+
+REGISTER_PERM_CHAINS(PermRead64Chain4Loop, 8, 4);
+
+// follow 8 independent 64-bit permutation cycles at once (Assembler version)
+void PermRead64Chain8Loop(char* memarea, size_t, size_t repeats)
+{
+    asm volatile(
+        "mov    %[memarea], %%rax \n"   // rax = iterator of chain 0
+        "lea    64(%[memarea]), %%rcx \n"
+        "lea    128(%[memarea]), %%rdx \n"
+        "lea    192(%[memarea]), %%rsi \n"
+        "lea    256(%[memarea]), %%rdi \n"
+        "lea    320(%[memarea]), %%r8 \n"
+        "lea    384(%[memarea]), %%r9 \n"
+        "lea    448(%[memarea]), %%r10 \n"
+        "1: \n" // start of repeat loop
+        "2: \n" // start of read loop
+        "mov    (%%rax), %%rax \n"
+        "mov    (%%rcx), %%rcx \n"
+        "mov    (%%rdx), %%rdx \n"
+        "mov    (%%rsi), %%rsi \n"
+        "mov    (%%rdi), %%rdi \n"
+        "mov    (%%r8), %%r8 \n"
+        "mov    (%%r9), %%r9 \n"
+        "mov    (%%r10), %%r10 \n"
+        // test read loop condition
+        "cmp    %%rax, %[memarea] \n"   // compare chain 0 to its first iterator
+        "jne    2b \n"
+        // test repeat loop condition
+        "dec    %[repeats] \n"          // until repeats = 0
+        "jnz    1b \n"
+        : [repeats] "+r" (repeats)
+        : [memarea] "r" (memarea)
+        : "rax", "rcx", "rdx", "rsi", "rdi", "r8", "r9", "r10", "cc", "memory");
+}
+
+REGISTER_PERM_CHAINS(PermRead64Chain8Loop, 8, 8);
+
+// follow 16 independent 64-bit permutation cycles at once (Assembler version)
+void PermRead64Chain16Loop(char* memarea, size_t, size_t repeats)
+{
+    // too many chains for registers: keep iterators in an array
+    char* iter[16];
+    for (unsigned int c = 0; c < 16; ++c)
+        iter[c] = memarea + 64 * c;
+
+    asm volatile(
+        "1: \n" // start of repeat loop
+        "2: \n" // start of read loop
+        "mov    0(%[iter]), %%rax \n"
+        "mov    (%%rax), %%rax \n"
+        "mov    %%rax, 0(%[iter]) \n"
+        "mov    8(%[iter]), %%rcx \n"
+        "mov    (%%rcx), %%rcx \n"
+        "mov    %%rcx, 8(%[iter]) \n"
+        "mov    16(%[iter]), %%rdx \n"
+        "mov    (%%rdx), %%rdx \n"
+        "mov    %%rdx, 16(%[iter]) \n"
+        "mov    24(%[iter]), %%rsi \n"
+        "mov    (%%rsi), %%rsi \n"
+        "mov    %%rsi, 24(%[iter]) \n"
+
+        "mov    32(%[iter]), %%rax \n"
+        "mov    (%%rax), %%rax \n"
+        "mov    %%rax, 32(%[iter]) \n"
+        "mov    40(%[iter]), %%rcx \n"
+        "mov    (%%rcx), %%rcx \n"
+        "mov    %%rcx, 40(%[iter]) \n"
+        "mov    48(%[iter]), %%rdx \n"
+        "mov    (%%rdx), %%rdx \n"
+        "mov    %%rdx, 48(%[iter]) \n"
+        "mov    56(%[iter]), %%rsi \n"
+        "mov    (%%rsi), %%rsi \n"
+        "mov    %%rsi, 56(%[iter]) \n"
+
+        "mov    64(%[iter]), %%rax \n"
+        "mov    (%%rax), %%rax \n"
+        "mov    %%rax, 64(%[iter]) \n"
+        "mov    72(%[iter]), %%rcx \n"
+        "mov    (%%rcx), %%rcx \n"
+        "mov    %%rcx, 72(%[iter]) \n"
+        "mov    80(%[iter]), %%rdx \n"
+        "mov    (%%rdx), %%rdx \n"
+        "mov    %%rdx, 80(%[iter]) \n"
+        "mov    88(%[iter]), %%rsi \n"
+        "mov    (%%rsi), %%rsi \n"
+        "mov    %%rsi, 88(%[iter]) \n"
+
+        "mov    96(%[iter]), %%rax \n"
+        "mov    (%%rax), %%rax \n"
+        "mov    %%rax, 96(%[iter]) \n"
+        "mov    104(%[iter]), %%rcx \n"
+        "mov    (%%rcx), %%rcx \n"
+        "mov    %%rcx, 104(%[iter]) \n"
+        "mov    112(%[iter]), %%rdx \n"
+        "mov    (%%rdx), %%rdx \n"
+        "mov    %%rdx, 112(%[iter]) \n"
+        "mov    120(%[iter]), %%rsi \n"
+        "mov    (%%rsi), %%rsi \n"
+        "mov    %%rsi, 120(%[iter]) \n"
+        // test read loop condition
+        "cmp    (%[iter]), %[memarea] \n"   // compare chain 0 to its first iterator
+        "jne    2b \n"
+        // test repeat loop condition
+        "dec    %[repeats] \n"          // until repeats = 0
+        "jnz    1b \n"
+        : [repeats] "+r" (repeats)
+        : [memarea] "r" (memarea), [iter] "r" (iter)
+        : "rax", "rcx", "rdx", "rsi", "cc", "memory");
+}
+
+REGISTER_PERM_CHAINS(PermRead64Chain16Loop, 8, 16);
+
+// follow 32 independent 64-bit permutation cycles at once (Assembler version)
+void PermRead64Chain32Loop(char* memarea, size_t, size_t repeats)
+{
+    // too many chains for registers: keep iterators in an array
+    char* iter[32];
+    for (unsigned int c = 0; c < 32; ++c)
+        iter[c] = memarea + 64 * c;
+
+    asm volatile(
+        "1: \n" // start of repeat loop
+        "2: \n" // start of read loop
+        "mov    0(%[iter]), %%rax \n"
+        "mov    (%%rax), %%rax \n"
+        "mov    %%rax, 0(%[iter]) \n"
+        "mov    8(%[iter]), %%rcx \n"
+        "mov    (%%rcx), %%rcx \n"
+        "mov    %%rcx, 8(%[iter]) \n"
+        "mov    16(%[iter]), %%rdx \n"
+        "mov    (%%rdx), %%rdx \n"
+        "mov    %%rdx, 16(%[iter]) \n"
+        "mov    24(%[iter]), %%rsi \n"
+        "mov    (%%rsi), %%rsi \n"
+        "mov    %%rsi, 24(%[iter]) \n"
+
+        "mov    32(%[iter]), %%rax \n"
+        "mov    (%%rax), %%rax \n"
+        "mov    %%rax, 32(%[iter]) \n"
+        "mov    40(%[iter]), %%rcx \n"
+        "mov    (%%rcx), %%rcx \n"
+        "mov    %%rcx, 40(%[iter]) \n"
+        "mov    48(%[iter]), %%rdx \n"
+        "mov    (%%rdx), %%rdx \n"
+        "mov    %%rdx, 48(%[iter]) \n"
+        "mov    56(%[iter]), %%rsi \n"
+        "mov    (%%rsi), %%rsi \n"
+        "mov    %%rsi, 56(%[iter]) \n"
+
+        "mov    64(%[iter]), %%rax \n"
+        "mov    (%%rax), %%rax \n"
+        "mov    %%rax, 64(%[iter]) \n"
+        "mov    72(%[iter]), %%rcx \n"
+        "mov    (%%rcx), %%rcx \n"
+        "mov    %%rcx, 72(%[iter]) \n"
+        "mov    80(%[iter]), %%rdx \n"
+        "mov    (%%rdx), %%rdx \n"
+        "mov    %%rdx, 80(%[iter]) \n"
+        "mov    88(%[iter]), %%rsi \n"
+        "mov    (%%rsi), %%rsi \n"
+        "mov    %%rsi, 88(%[iter]) \n"
+
+        "mov    96(%[iter]), %%rax \n"
+        "mov    (%%rax), %%rax \n"
+        "mov    %%rax, 96(%[iter]) \n"
+        "mov    104(%[iter]), %%rcx \n"
+        "mov    (%%rcx), %%rcx \n"
+        "mov    %%rcx, 104(%[iter]) \n"
+        "mov    112(%[iter]), %%rdx \n"
+        "mov    (%%rdx), %%rdx \n"
+        "mov    %%rdx, 112(%[iter]) \n"
+        "mov    120(%[iter]), %%rsi \n"
+        "mov    (%%rsi), %%rsi \n"
+        "mov    %%rsi, 120(%[iter]) \n"
+
+        "mov    128(%[iter]), %%rax \n"
+        "mov    (%%rax), %%rax \n"
+        "mov    %%rax, 128(%[iter]) \n"
+        "mov    136(%[iter]), %%rcx \n"
+        "mov    (%%rcx), %%rcx \n"
+        "mov    %%rcx, 136(%[iter]) \n"
+        "mov    144(%[iter]), %%rdx \n"
+        "mov    (%%rdx), %%rdx \n"
+        "mov    %%rdx, 144(%[iter]) \n"
+        "mov    152(%[iter]), %%rsi \n"
+        "mov    (%%rsi), %%rsi \n"
+        "mov    %%rsi, 152(%[iter]) \n"
+
+        "mov    160(%[iter]), %%rax \n"
+        "mov    (%%rax), %%rax \n"
+        "mov    %%rax, 160(%[iter]) \n"
+        "mov    168(%[iter]), %%rcx \n"
+        "mov    (%%rcx), %%rcx \n"
+        "mov    %%rcx, 168(%[iter]) \n"
+        "mov    176(%[iter]), %%rdx \n"
+        "mov    (%%rdx), %%rdx \n"
+        "mov    %%rdx, 176(%[iter]) \n"
+        "mov    184(%[iter]), %%rsi \n"
+        "mov    (%%rsi), %%rsi \n"
+        "mov    %%rsi, 184(%[iter]) \n"
+
+        "mov    192(%[iter]), %%rax \n"
+        "mov    (%%rax), %%rax \n"
+        "mov    %%rax, 192(%[iter]) \n"
+        "mov    200(%[iter]), %%rcx \n"
+        "mov    (%%rcx), %%rcx \n"
+        "mov    %%rcx, 200(%[iter]) \n"
+        "mov    208(%[iter]), %%rdx \n"
+        "mov    (%%rdx), %%rdx \n"
+        "mov    %%rdx, 208(%[iter]) \n"
+        "mov    216(%[iter]), %%rsi \n"
+        "mov    (%%rsi), %%rsi \n"
+        "mov    %%rsi, 216(%[iter]) \n"
+
+        "mov    224(%[iter]), %%rax \n"
+        "mov    (%%rax), %%rax \n"
+        "mov    %%rax, 224(%[iter]) \n"
+        "mov    232(%[iter]), %%rcx \n"
+        "mov    (%%rcx), %%rcx \n"
+        "mov    %%rcx, 232(%[iter]) \n"
+        "mov    240(%[iter]), %%rdx \n"
+        "mov    (%%rdx), %%rdx \n"
+        "mov    %%rdx, 240(%[iter]) \n"
+        "mov    248(%[iter]), %%rsi \n"
+        "mov    (%%rsi), %%rsi \n"
+        "mov    %%rsi, 248(%[iter]) \n"
+        // test read loop condition
+        "cmp    (%[iter]), %[memarea] \n"   // compare chain 0 to its first iterator
+        "jne    2b \n"
+        // test repeat loop condition
+        "dec    %[repeats] \n"          // until repeats = 0
+        "jnz    1b \n"
+        : [repeats] "+r" (repeats)
+        : [memarea] "r" (memarea), [iter] "r" (iter)
+        : "rax", "rcx", "rdx", "rsi", "cc", "memory");
+}
+
+REGISTER_PERM_CHAINS(PermRead64Chain32Loop, 8, 32);
+
 // -----------------------------------------------------------------------------
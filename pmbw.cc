@@ -30,17 +30,35 @@
 #include <fstream>
 #include <iomanip>
 #include <vector>
+#include <map>
+#include <set>
+#include <algorithm>
 
 #include <stdlib.h>
 #include <inttypes.h>
+#include <limits.h>
 #include <string.h>
+#include <math.h>
+#include <errno.h>
 #include <assert.h>
 #include <unistd.h>
 #include <time.h>
 
 #include <pthread.h>
+#include <sched.h>
 #include <malloc.h>
 
+#if __linux__
+#include <sys/syscall.h>
+#include <sys/mman.h>
+#include <sys/ioctl.h>
+#include <linux/perf_event.h>
+#endif
+
+#if !ON_WINDOWS
+#include <sys/utsname.h>
+#endif
+
 #if ON_WINDOWS
 #include <windows.h>
 #endif
@@ -76,6 +94,38 @@ bool gopt_testcycle = false;
 // option to change the output file from default "stats.txt"
 const char* gopt_output_file = "stats.txt";
 
+// format of the output file: "txt" (RESULT lines), "jsonl" or "csv"
+const char* gopt_format = "txt";
+
+// thread affinity policy or cpu list, NULL lets the OS schedule threads
+const char* gopt_affinity = NULL;
+
+// benchmark mode: "sweep" over array sizes and thread counts, "numamatrix"
+// or "loaded"
+const char* gopt_mode = "sweep";
+
+// timer for measurements: "clock" (clock_gettime) or "counter" (cycle counter)
+const char* gopt_timer = "clock";
+
+// number of measurements per array size and thread count
+size_t gopt_trials = 1;
+
+// stop further trials once the 95% confidence interval of the mean runtime
+// is within this fraction of the mean, 0 runs all trials
+double gopt_relerr = 0;
+
+// name of the kernel run by load threads in loaded latency mode
+const char* gopt_loadfunc = NULL;
+
+// delays between the chunks of load threads in loaded latency mode
+std::vector<int> gopt_load_delays;
+
+// buffer size of each load thread in loaded latency mode, 0 for the default
+uint64_t gopt_loadsize = 0;
+
+// strides of strided test functions, swept in this order
+std::vector<uint64_t> gopt_strides;
+
 // error writers
 #define ERR(x)  do { std::cerr << x << std::endl; } while(0)
 #define ERRX(x)  do { (std::cerr << x).flush(); } while(0)
@@ -87,6 +137,13 @@ size_t g_memsize = 0;
 // global test function currently run
 const struct TestFunction* g_func = NULL;
 
+// kernel run by threads 1..n-1 while thread 0 runs g_func in loaded latency
+// mode, NULL otherwise
+const struct TestFunction* g_loadfunc = NULL;
+
+// bytes from one access to the next of strided test functions
+size_t g_stride = 64;
+
 // number of physical cpus detected
 int g_physical_cpus;
 
@@ -121,23 +178,42 @@ struct TestFunction
     // fill the area with a permutation before calling the func
     bool make_permutation;
 
+    // number of equally sized arrays the func accesses, the thread's area is
+    // divided into this many arrays and func is passed the size of one.
+    unsigned int streams;
+
+    // number of independent permutation cycles the func walks at once, the
+    // first pointer of cycle c is in cache line c of the area.
+    unsigned int chains;
+
+    // func skips forward g_stride bytes between accesses instead of
+    // access_offset
+    bool strided;
+
     // constructor which also registers the function
     TestFunction(const char* n, testfunc_type f, const char* cf,
                  unsigned int bpa, unsigned int ao, unsigned int unr,
-                 bool mp);
+                 bool mp, unsigned int st = 1, unsigned int ch = 1,
+                 bool sd = false);
 
     // test CPU feature support
     bool is_supported() const;
+
+    // bytes skipped forward to next access point in the current test
+    size_t offset() const
+    {
+        return strided ? g_stride : access_offset;
+    }
 };
 
 std::vector<TestFunction*> g_testlist;
 
 TestFunction::TestFunction(const char* n, testfunc_type f, const char* cf,
                            unsigned int bpa, unsigned int ao, unsigned int unr,
-                           bool mp)
+                           bool mp, unsigned int st, unsigned int ch, bool sd)
     : name(n), func(f), cpufeat(cf),
       bytes_per_access(bpa), access_offset(ao), unroll_factor(unr),
-      make_permutation(mp)
+      make_permutation(mp), streams(st), chains(ch), strided(sd)
 {
     g_testlist.push_back(this);
 }
@@ -154,6 +230,20 @@ TestFunction::TestFunction(const char* n, testfunc_type f, const char* cf,
     static const struct TestFunction* _##func##_register =       \
         new TestFunction(#func,func,NULL,bytes,bytes,1,true);
 
+// the area is a multiple of 64 bytes per chain, so all chains have the same
+// number of full cache lines.
+#define REGISTER_PERM_CHAINS(func, bytes, chains)               \
+    static const struct TestFunction* _##func##_register =       \
+        new TestFunction(#func,func,NULL,bytes,bytes,64/bytes*chains,true,1,chains);
+
+#define REGISTER_STREAMS(func, cpufeat, bytes, unroll, streams) \
+    static const struct TestFunction* _##func##_register =       \
+        new TestFunction(#func,func,cpufeat,bytes,bytes,unroll,false,streams);
+
+#define REGISTER_STRIDE(func, bytes)                            \
+    static const struct TestFunction* _##func##_register =       \
+        new TestFunction(#func,func,NULL,bytes,bytes,1,false,1,1,true);
+
 // -----------------------------------------------------------------------------
 // --- Test Functions with Inline Assembler Loops
 
@@ -182,9 +272,38 @@ static inline void cpuid(int op, int out[4])
         );
 }
 
+//  gcc inline assembly for CPUID instruction with sub-leaf in ecx
+static inline void cpuid_count(int op, int subop, int out[4])
+{
+    asm volatile("cpuid"
+                 : "=a" (out[0]), "=b" (out[1]), "=c" (out[2]), "=d" (out[3])
+                 : "a" (op), "c" (subop)
+        );
+}
+
+//  gcc inline assembly for XGETBV instruction, reads extended control register
+static inline uint64_t xgetbv(unsigned int index)
+{
+    uint32_t eax, edx;
+    asm volatile(".byte 0x0f, 0x01, 0xd0" // xgetbv, for older assemblers
+                 : "=a" (eax), "=d" (edx)
+                 : "c" (index)
+        );
+    return ((uint64_t)edx << 32) | eax;
+}
+
 // cpuid op 1 result
 int g_cpuid_op1[4];
 
+// cpuid op 7 sub-leaf 0 result
+int g_cpuid_op7[4];
+
+// XCR0 register: register state enabled by the OS via XSAVE
+uint64_t g_xcr0 = 0;
+
+// cpuid op 0x80000007 result
+int g_cpuid_ext7[4];
+
 // check for MMX instructions
 static bool cpuid_mmx()
 {
@@ -197,10 +316,34 @@ static bool cpuid_sse()
     return (g_cpuid_op1[3] & ((int)1 << 25));
 }
 
+// check whether OS saves SSE and AVX (ymm) registers: XCR0 bits 1 and 2
+static bool os_avx_state()
+{
+    return (g_xcr0 & 0x06) == 0x06;
+}
+
+// check whether OS saves AVX-512 opmask and zmm registers: XCR0 bits 5-7
+static bool os_avx512_state()
+{
+    return (g_xcr0 & 0xE6) == 0xE6;
+}
+
 // check for AVX instructions
 static bool cpuid_avx()
 {
-    return (g_cpuid_op1[2] & ((int)1 << 28));
+    return (g_cpuid_op1[2] & ((int)1 << 28)) && os_avx_state();
+}
+
+// check for AVX-512 Foundation instructions
+static bool cpuid_avx512f()
+{
+    return (g_cpuid_op7[1] & ((int)1 << 16)) && os_avx512_state();
+}
+
+// check for an invariant TSC, which ticks at a constant rate in all states
+static bool cpuid_invtsc()
+{
+    return (g_cpuid_ext7[3] & ((int)1 << 8));
 }
 
 // run CPUID and print output
@@ -209,9 +352,26 @@ static void cpuid_detect()
     ERRX("CPUID:");
     cpuid(1, g_cpuid_op1);
 
+    // check highest standard leaf before querying leaf 7
+    int op0[4];
+    cpuid(0, op0);
+    if (op0[0] >= 7)
+        cpuid_count(7, 0, g_cpuid_op7);
+
+    // OSXSAVE flag signals that XGETBV may be used to read XCR0
+    if (g_cpuid_op1[2] & ((int)1 << 27))
+        g_xcr0 = xgetbv(0);
+
+    // check highest extended leaf before querying leaf 0x80000007
+    cpuid(0x80000000, op0);
+    if ((unsigned int)op0[0] >= 0x80000007)
+        cpuid(0x80000007, g_cpuid_ext7);
+
     if (cpuid_mmx()) ERRX(" mmx");
     if (cpuid_sse()) ERRX(" sse");
     if (cpuid_avx()) ERRX(" avx");
+    if (cpuid_avx512f()) ERRX(" avx512f");
+    if (cpuid_invtsc()) ERRX(" invtsc");
     ERR("");
 }
 
@@ -222,6 +382,7 @@ bool TestFunction::is_supported() const
     if (strcmp(cpufeat,"mmx") == 0) return cpuid_mmx();
     if (strcmp(cpufeat,"sse") == 0) return cpuid_sse();
     if (strcmp(cpufeat,"avx") == 0) return cpuid_avx();
+    if (strcmp(cpufeat,"avx512f") == 0) return cpuid_avx512f();
     return false;
 }
 #else
@@ -265,6 +426,46 @@ parse_uint64t(const char* value, uint64_t& out)
     return (endp && *endp == 0);
 }
 
+// parse a comma separated list of sizes with suffixes like 8,64,4K,2M
+static bool
+parse_sizelist(const char* value, std::vector<uint64_t>& out)
+{
+    out.clear();
+
+    std::istringstream iss(value);
+    std::string item;
+    while (std::getline(iss, item, ','))
+    {
+        uint64_t v;
+        if (item.empty() || !parse_uint64t(item.c_str(), v)) return false;
+        out.push_back(v);
+    }
+
+    return !out.empty();
+}
+
+// parse a comma separated list of non-negative integers like 0,100,1000
+static bool
+parse_intlist(const char* value, std::vector<int>& out)
+{
+    out.clear();
+
+    std::istringstream iss(value);
+    std::string item;
+    while (std::getline(iss, item, ','))
+    {
+        char* endp;
+        errno = 0;
+        long v = strtol(item.c_str(), &endp, 10);
+        if (item.empty() || item[0] < '0' || item[0] > '9' || *endp != 0 ||
+            errno == ERANGE || v > INT_MAX)
+            return false;
+        out.push_back(v);
+    }
+
+    return !out.empty();
+}
+
 // parse a number as int with error detection
 static inline bool
 parse_int(const char* value, int& out)
@@ -306,9 +507,40 @@ struct LCGRandom
     }
 };
 
+// use the calibrated cycle counter for time measurement instead of
+// clock_gettime()
+bool g_use_cycle_counter = false;
+
+// frequency of the cycle counter, 0 if not available
+double g_cycle_hz = 0;
+
+// read the cycle counter: the TSC on x86, the generic timer on arm64. The
+// fences keep earlier loads from being timed after the read.
+static inline uint64_t cycle_counter()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    uint32_t lo, hi;
+    asm volatile("lfence \n"
+                 "rdtsc \n"
+                 : "=a" (lo), "=d" (hi) : : "memory");
+    return ((uint64_t)hi << 32) | lo;
+#elif defined(__aarch64__)
+    uint64_t cnt;
+    asm volatile("isb \n"
+                 "mrs    %0, cntvct_el0 \n"
+                 : "=r" (cnt) : : "memory");
+    return cnt;
+#else
+    return 0;
+#endif
+}
+
 // return time stamp for time measurement
 static inline double timestamp()
 {
+    if (g_use_cycle_counter)
+        return cycle_counter() / g_cycle_hz;
+
     struct timespec ts;
 #ifdef __bgq__
     // CLOCK_MONOTONIC is not supported on BG/Q
@@ -319,6 +551,29 @@ static inline double timestamp()
     return ts.tv_sec + ts.tv_nsec * 1e-9;
 }
 
+// check for a usable constant rate cycle counter and measure its frequency
+// against clock_gettime() for 50 milliseconds
+static void calibrate_cycle_counter()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    if (!cpuid_invtsc()) return;
+#elif !defined(__aarch64__)
+    return;
+#endif
+
+    double ts1 = timestamp();
+    uint64_t c1 = cycle_counter();
+
+    double ts2;
+    do {
+        ts2 = timestamp();
+    } while (ts2 - ts1 < 0.05);
+
+    uint64_t c2 = cycle_counter();
+
+    g_cycle_hz = (c2 - c1) / (ts2 - ts1);
+}
+
 // return true if the funcname is selected via command line arguments
 static inline bool match_funcfilter(const char* funcname)
 {
@@ -334,407 +589,3274 @@ static inline bool match_funcfilter(const char* funcname)
 }
 
 // -----------------------------------------------------------------------------
-// --- List of Array Sizes to Test
+// --- CPU Topology and Thread Affinity
 
-const uint64_t areasize_list[] = {
-    1 * 1024,                   // 1 KiB
-    2 * 1024,
-    3 * 1024,
-    4 * 1024,
-    6 * 1024,
-    8 * 1024,
-    12 * 1024,
-    16 * 1024,
-    20 * 1024,
-    24 * 1024,
-    28 * 1024,
-    32 * 1024,
-    40 * 1024,
-    48 * 1024,
-    64 * 1024,
-    96 * 1024,
-    128 * 1024,
-    192 * 1024,
-    256 * 1024,
-    384 * 1024,
-    512 * 1024,
-    768 * 1024,
-    1024 * 1024,                // 1 MiB
-    (1024 + 256) * 1024,	// 1.25 MiB
-    (1024 + 512) * 1024,	// 1.5 MiB
-    (1024 + 768) * 1024,	// 1.75 MiB
-    2048 * 1024,                // 2 MiB = common L2 cache size
-    (2048 + 256) * 1024,	// 2.25
-    (2048 + 512) * 1024,	// 2.5
-    (2048 + 768) * 1024,	// 2.75
-    3 * 1024 * 1024,            // 3 MiB = common L2 cache size
-    4 * 1024 * 1024,            // 4 MiB
-    5 * 1024 * 1024,            // 5 MiB
-    6 * 1024 * 1024,            // 6 MiB = common L2 cache size
-    7 * 1024 * 1024,            // 7 MiB
-    8 * 1024 * 1024,            // 8 MiB = common L2 cache size
-    9 * 1024 * 1024,
-    10 * 1024 * 1024,
-    12 * 1024 * 1024,
-    14 * 1024 * 1024,
-    16 * 1024 * 1024,
-    20 * 1024 * 1024,
-    24 * 1024 * 1024,
-    28 * 1024 * 1024,
-    32 * 1024 * 1024,
-    40 * 1024 * 1024,
-    48 * 1024 * 1024,
-    56 * 1024 * 1024,
-    64 * 1024 * 1024,
-    128 * 1024 * 1024,
-    256 * 1024 * 1024,
-    512 * 1024 * 1024,
-    1 * 1024 * 1024 * 1024LLU,          // 1 GiB
-    2 * 1024 * 1024 * 1024LLU,
-    4 * 1024 * 1024 * 1024LLU,
-    8 * 1024 * 1024 * 1024LLU,
-    16 * 1024 * 1024 * 1024LLU,
-    32 * 1024 * 1024 * 1024LLU,
-    64 * 1024 * 1024 * 1024LLU,
-    128 * 1024 * 1024 * 1024LLU,
-    256 * 1024 * 1024 * 1024LLU,
-    512 * 1024 * 1024 * 1024LLU,
-    1024 * 1024 * 1024 * 1024LLU,       // 1 TiB
-    0   // list termination
-};
+// parse a list of ids like "0,2,4-7" as used by sysfs and taskset, with all
+// ids below limit, which is checked before expanding ranges.
+static inline bool
+parse_idlist(const char* value, std::vector<int>& out, long limit)
+{
+    out.clear();
+    const char* p = value;
 
-// -----------------------------------------------------------------------------
-// --- Main Program
+    while (*p)
+    {
+        char* endp;
+        long first = strtol(p, &endp, 10), last = first;
+        if (endp == p || first < 0 || first >= limit) return false;
+        p = endp;
+
+        if (*p == '-') {
+            last = strtol(p + 1, &endp, 10);
+            if (endp == p + 1 || last < first || last >= limit) return false;
+            p = endp;
+        }
+        for (long c = first; c <= last; ++c)
+            out.push_back(c);
 
-// flag for terminating current test
-bool g_done;
+        if (*p == ',') ++p;
+        else if (*p == '\n' || *p == 0) break;
+        else return false;
+    }
 
-// global current number of threads
-int g_nthreads = 0;
+    return !out.empty();
+}
 
-// synchronization barrier for current thread counter
-pthread_barrier_t g_barrier;
+// parse a cpu list like "0,2,4-7", with cpu ids below the number of
+// configured cpus, which also fit into a cpu_set_t.
+static inline bool
+parse_cpulist(const char* value, std::vector<int>& out)
+{
+#if ON_WINDOWS
+    SYSTEM_INFO sysinfo;
+    GetSystemInfo(&sysinfo);
+    long limit = sysinfo.dwNumberOfProcessors;
+#else
+    long limit = sysconf(_SC_NPROCESSORS_CONF);
+#endif
+#ifdef CPU_SETSIZE
+    limit = std::min<long>(limit, CPU_SETSIZE);
+#endif
+    return parse_idlist(value, out, limit);
+}
 
-// thread shared parameters for test function
-uint64_t g_thrsize;
-uint64_t g_thrsize_spaced;
-uint64_t g_repeats;
+// read a single integer from a (sysfs) file, return -1 on error
+static inline int read_file_int(const char* path)
+{
+    std::ifstream in(path);
+    int value = -1;
+    if (!(in >> value)) return -1;
+    return value;
+}
 
-// Create a one-cycle permutation of pointers in the memory area
-void make_cyclic_permutation(int thread_num, void* memarea, size_t bytesize)
+// topology information about one online cpu
+struct CpuTopology
 {
-    void** ptrarray = (void**)memarea;
-    size_t size = bytesize / sizeof(void*);
+    int cpu, package, core;
 
-    if (thread_num == 0)
-        (std::cout << "Make permutation:").flush();
+    // sort order: package, core, then cpu number (SMT siblings adjacent)
+    bool operator< (const CpuTopology& b) const
+    {
+        if (package != b.package) return package < b.package;
+        if (core != b.core) return core < b.core;
+        return cpu < b.cpu;
+    }
+};
 
-    // *** Barrier ****
-    pthread_barrier_wait(&g_barrier);
+// detected topology of all cpus the process may run on, sorted compactly
+std::vector<CpuTopology> g_topology;
 
-    (std::cout << " filling").flush();
+// cpu the thread with each number is pinned to, cycled if more threads
+std::vector<int> g_cpu_order;
 
-    for (size_t i = 0; i < size; ++i)
+// per-thread information recorded during each test run
+struct ThreadInfo
+{
+    // cpu the thread ran on at the end of the test
+    int cpu;
+
+    // runtime of the thread's own test function call, the time it finished,
+    // and the time it then waited in the barrier for the slowest thread
+    double runtime, endtime, barrierwait;
+
+    // bytes accessed and time taken by a load thread in loaded latency mode
+    uint64_t loadbytes;
+    double loadtime;
+
+    // file descriptors and counts of hardware performance counters
+    std::vector<int> perf_fd;
+    std::vector<int64_t> perf_count;
+
+    ThreadInfo()
+        : cpu(-1), runtime(0), endtime(0), barrierwait(0),
+          loadbytes(0), loadtime(0) { }
+};
+
+std::vector<ThreadInfo> g_threadinfo;
+
+#if __linux__
+
+// read cpu topology of allowed cpus from sysfs
+static void detect_topology()
+{
+    cpu_set_t cpuset;
+    CPU_ZERO(&cpuset);
+    if (sched_getaffinity(0, sizeof(cpuset), &cpuset) != 0) return;
+
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
     {
-        ptrarray[i] = &ptrarray[i]; // fill area with pointers to self-address
-    }
+        if (!CPU_ISSET(cpu, &cpuset)) continue;
 
-    (std::cout << " permuting").flush();
+        char path[256];
+        CpuTopology t;
+        t.cpu = cpu;
 
-    LCGRandom srnd((size_t)ptrarray + 233349568);
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/topology/physical_package_id", cpu);
+        t.package = std::max(read_file_int(path), 0);
 
-    for (size_t n = size; n > 1; --n)
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/topology/core_id", cpu);
+        t.core = read_file_int(path);
+        if (t.core < 0) t.core = cpu;
+
+        g_topology.push_back(t);
+    }
+
+    std::sort(g_topology.begin(), g_topology.end());
+}
+
+// order cpus such that each physical core is used once before SMT siblings
+static std::vector<CpuTopology>
+physical_first(const std::vector<CpuTopology>& topo)
+{
+    // rank of each cpu among the SMT siblings of its core (topo is sorted)
+    std::vector<size_t> rank(topo.size(), 0);
+    size_t maxrank = 0;
+    for (size_t i = 1; i < topo.size(); ++i)
     {
-        size_t i = srnd() % (n-1);      // permute pointers to one-cycle
-        std::swap( ptrarray[i], ptrarray[n-1] );
+        if (topo[i-1].package == topo[i].package && topo[i-1].core == topo[i].core)
+            rank[i] = rank[i-1] + 1;
+        maxrank = std::max(maxrank, rank[i]);
     }
 
-    if (gopt_testcycle)
+    std::vector<CpuTopology> out;
+    for (size_t r = 0; r <= maxrank; ++r)
     {
-        (std::cout << " testing").flush();
+        for (size_t i = 0; i < topo.size(); ++i)
+        {
+            if (rank[i] == r) out.push_back(topo[i]);
+        }
+    }
+
+    return out;
+}
+
+// build g_cpu_order from an affinity policy name or an explicit cpu list
+static bool make_affinity_order(const char* policy)
+{
+    g_cpu_order.clear();
 
-        void* ptr = ptrarray[0];
-        size_t steps = 1;
+    if (strcmp(policy, "compact") == 0)
+    {
+        // fill SMT siblings, then cores, then packages
+        for (size_t i = 0; i < g_topology.size(); ++i)
+            g_cpu_order.push_back(g_topology[i].cpu);
+    }
+    else if (strcmp(policy, "physical") == 0)
+    {
+        // one thread per physical core first, then the SMT siblings
+        std::vector<CpuTopology> order = physical_first(g_topology);
+        for (size_t i = 0; i < order.size(); ++i)
+            g_cpu_order.push_back(order[i].cpu);
+    }
+    else if (strcmp(policy, "scatter") == 0)
+    {
+        // round-robin over packages, physical cores before SMT siblings
+        std::vector<CpuTopology> order = physical_first(g_topology);
+        std::map<int, std::vector<int> > packages;
+        for (size_t i = 0; i < order.size(); ++i)
+            packages[order[i].package].push_back(order[i].cpu);
 
-        while ( ptr != &ptrarray[0] && steps < size*2 )
+        for (size_t k = 0; g_cpu_order.size() != order.size(); ++k)
         {
-            ptr = *(void**)ptr;         // walk pointer
-            ++steps;
+            for (std::map<int, std::vector<int> >::const_iterator
+                     it = packages.begin(); it != packages.end(); ++it)
+            {
+                if (k < it->second.size())
+                    g_cpu_order.push_back(it->second[k]);
+            }
         }
-        (std::cout << " cycle=" << steps).flush();
-
-        assert(steps == size);
     }
     else
     {
-        (std::cout << " cycle=" << size).flush();
+        // explicit list of cpus
+        if (!parse_cpulist(policy, g_cpu_order)) return false;
     }
 
-    // *** Barrier ****
-    pthread_barrier_wait(&g_barrier);
+    return !g_cpu_order.empty();
+}
 
-    if (thread_num == 0)
-        std::cout << std::endl;
+// pin the calling thread to a cpu, return false on failure
+static bool pin_cpu(int cpu)
+{
+    cpu_set_t cpuset;
+    CPU_ZERO(&cpuset);
+    CPU_SET(cpu, &cpuset);
+
+    int r = pthread_setaffinity_np(pthread_self(), sizeof(cpuset), &cpuset);
+    if (r != 0) {
+        ERR("Error pinning thread to cpu " << cpu << ": " << strerror(r));
+        return false;
+    }
+    return true;
 }
 
-void* thread_master(void* cookie)
+// pin the calling thread to its cpu in g_cpu_order
+static void pin_thread(int thread_num)
 {
-    // this weirdness is because (void*) cannot be cast to int and back.
-    int thread_num = *((int*)cookie);
-    delete (int*)cookie;
+    if (g_cpu_order.empty()) return;
 
-    // initial repeat factor is just an approximate B/s bandwidth
-    uint64_t factor = 1024*1024*1024;
+    pin_cpu(g_cpu_order[thread_num % g_cpu_order.size()]);
+}
 
-    for (const uint64_t* areasize = areasize_list; *areasize; ++areasize)
-    {
-        if (*areasize < gopt_sizelimit_min && gopt_sizelimit_min != 0) {
-            ERR("Skipping " << g_func->name << " test with " << *areasize
-                << " minimum array size due to -s " << gopt_sizelimit_min << ".");
-            continue;
-        }
-        if (*areasize > gopt_sizelimit_max && gopt_sizelimit_max != 0) {
-            ERR("Skipping " << g_func->name << " test with " << *areasize
-                << " maximum array size due to -S " << gopt_sizelimit_max << ".");
-            continue;
-        }
+// allow the calling thread to run on all cpus available to the process
+static void unpin_thread()
+{
+    if (g_cpu_order.empty()) return;
 
-        for (unsigned int round = 0; round < 1; ++round)
-        {
-            // divide area by thread number
-            g_thrsize = *areasize / g_nthreads;
+    cpu_set_t cpuset;
+    CPU_ZERO(&cpuset);
+    for (size_t i = 0; i < g_topology.size(); ++i)
+        CPU_SET(g_topology[i].cpu, &cpuset);
 
-            // unrolled tests do up to 16 accesses without loop check, thus align
-            // upward to next multiple of unroll_factor*size (e.g. 128 bytes for
-            // 16-times unrolled 64-bit access)
-            uint64_t unrollsize = g_func->unroll_factor * g_func->bytes_per_access;
-            g_thrsize = ((g_thrsize + unrollsize - 1) / unrollsize) * unrollsize;
+    pthread_setaffinity_np(pthread_self(), sizeof(cpuset), &cpuset);
+}
+
+// return cpu the calling thread is running on
+static inline int current_cpu()
+{
+    return sched_getcpu();
+}
+
+#else // !__linux__
+
+static void detect_topology()
+{
+}
+
+static bool make_affinity_order(const char*)
+{
+    ERR("Thread affinity is not supported on this platform.");
+    return false;
+}
+
+static bool pin_cpu(int)
+{
+    return false;
+}
+
+static void pin_thread(int)
+{
+}
+
+static void unpin_thread()
+{
+}
+
+static inline int current_cpu()
+{
+    return -1;
+}
+
+#endif // __linux__
+
+// output a comma separated list of cpus the threads ran on
+static inline std::string threadinfo_cpus()
+{
+    std::ostringstream oss;
+    for (size_t i = 0; i < g_threadinfo.size(); ++i)
+        oss << (i ? "," : "") << g_threadinfo[i].cpu;
+    return oss.str();
+}
+
+// -----------------------------------------------------------------------------
+// --- Memory Allocation with Huge Pages
+
+// huge page backing of the memory area: NULL, "thp", "2M" or "1G"
+const char* gopt_hugepages = NULL;
+
+// size of the pages backing the memory area
+size_t g_pagesize = 4096;
+
+// memory area was allocated via mmap() and must be unmapped
+bool g_memarea_mmap = false;
+
+// initialization of the memory area: "lazy" touches it in parallel up to the
+// extent each test needs, "full" touches all of it in parallel at startup and
+// "populate" lets mmap(MAP_POPULATE) fault it in.
+const char* gopt_meminit = "lazy";
+
+// bytes at the start of the memory area which were already touched
+size_t g_memarea_touched = 0;
+
+#if __linux__
+
+#ifndef MAP_HUGE_SHIFT
+#define MAP_HUGE_SHIFT 26
+#endif
+
+// return the size of the requested huge pages, 0 if invalid
+static size_t hugepage_size(const char* hugepages)
+{
+    if (strcmp(hugepages, "2M") == 0) return 2 * 1024 * 1024;
+    if (strcmp(hugepages, "1G") == 0) return 1024 * 1024 * 1024;
+    if (strcmp(hugepages, "thp") == 0) {
+        // size of transparent huge pages on this architecture
+        std::ifstream in("/sys/kernel/mm/transparent_hugepage/hpage_pmd_size");
+        size_t size = 0;
+        if (!(in >> size) || size == 0) size = 2 * 1024 * 1024;
+        return size;
+    }
+    return 0;
+}
+
+// return bytes of the memory area backed by transparent huge pages
+static size_t thp_backed_bytes()
+{
+    std::ifstream in("/proc/self/smaps");
+    std::string line;
+    bool inside = false;
+    size_t bytes = 0;
+
+    while (std::getline(in, line))
+    {
+        uintptr_t begin, end;
+        if (sscanf(line.c_str(), "%" SCNxPTR "-%" SCNxPTR " ", &begin, &end) == 2 &&
+            line.find(':') > line.find(' '))
+        {
+            // header line of a mapping
+            inside = (begin < (uintptr_t)g_memarea + g_memsize && (uintptr_t)g_memarea < end);
+        }
+        else if (inside && line.compare(0, 14, "AnonHugePages:") == 0)
+        {
+            bytes += strtoull(line.c_str() + 14, NULL, 10) * 1024;
+        }
+    }
+
+    return bytes;
+}
+
+#endif // __linux__
+
+// parse the huge page option
+static bool parse_hugepages(const char* value)
+{
+#if __linux__
+    if (hugepage_size(value) == 0) return false;
+    gopt_hugepages = value;
+    return true;
+#else
+    (void)value;
+    ERR("Huge pages are not supported on this platform.");
+    return false;
+#endif
+}
+
+// page size backing the first extent bytes of the memory area, and the bytes
+// backed by transparent huge pages: these are only requested, the kernel may
+// back the area with base pages instead.
+static size_t backing_pagesize(size_t extent, size_t& thpbytes)
+{
+    thpbytes = 0;
+#if __linux__
+    if (gopt_hugepages && strcmp(gopt_hugepages, "thp") == 0)
+    {
+        thpbytes = thp_backed_bytes();
+        if (thpbytes < std::min(extent, g_memsize))
+            return sysconf(_SC_PAGESIZE);
+    }
+#endif
+    (void)extent;
+    return g_pagesize;
+}
+
+// allocate g_memarea of g_memsize bytes, backed by huge pages if requested
+static bool alloc_memarea()
+{
+#if !ON_WINDOWS
+    g_pagesize = sysconf(_SC_PAGESIZE);
+#endif
+
+#if __linux__
+    if (gopt_hugepages)
+    {
+        g_pagesize = hugepage_size(gopt_hugepages);
+        // round up to full huge pages
+        g_memsize = (g_memsize + g_pagesize - 1) / g_pagesize * g_pagesize;
+    }
+
+    if (gopt_hugepages && strcmp(gopt_hugepages, "thp") != 0)
+    {
+        // explicit huge pages from the hugetlbfs pool
+        int pageshift = 0;
+        while (((size_t)1 << pageshift) < g_pagesize) ++pageshift;
+
+        int flags = MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | (pageshift << MAP_HUGE_SHIFT);
+        if (strcmp(gopt_meminit, "populate") == 0) flags |= MAP_POPULATE;
+
+        void* area = mmap(NULL, g_memsize, PROT_READ | PROT_WRITE, flags, -1, 0);
+        if (area == MAP_FAILED) {
+            ERR("Error allocating " << g_memsize / g_pagesize << " huge pages of " << gopt_hugepages
+                << ": " << strerror(errno) << ". Reserve them via /sys/kernel/mm/hugepages/.");
+            return false;
+        }
+
+        g_memarea = (char*)area;
+        g_memarea_mmap = true;
+        return true;
+    }
+
+    if (!gopt_hugepages && strcmp(gopt_meminit, "populate") == 0)
+    {
+        // let the kernel fault in all pages, page aligned
+        void* area = mmap(NULL, g_memsize, PROT_READ | PROT_WRITE,
+                          MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE, -1, 0);
+        if (area == MAP_FAILED) {
+            ERR("Error allocating memory: " << strerror(errno));
+            return false;
+        }
+
+        g_memarea = (char*)area;
+        g_memarea_mmap = true;
+        return true;
+    }
+#endif
+
+#if HAVE_POSIX_MEMALIGN
+
+    // align to page size, required for NUMA placement and huge pages, this
+    // also aligns to 64 bytes, the size of a cache line and of 512-bit
+    // operations
+    if (posix_memalign((void**)&g_memarea, g_pagesize, g_memsize) != 0) {
+        ERR("Error allocating memory.");
+        return false;
+    }
+
+#else
+
+    g_memarea = (char*)malloc(g_memsize);
+    if (!g_memarea) {
+        ERR("Error allocating memory.");
+        return false;
+    }
+
+#endif
+
+#if __linux__
+    // ask for transparent huge pages, which are created on first touch
+    if (gopt_hugepages && madvise(g_memarea, g_memsize, MADV_HUGEPAGE) != 0) {
+        ERR("Error enabling transparent huge pages: " << strerror(errno));
+    }
+#endif
+
+    return true;
+}
+
+// release g_memarea
+static void free_memarea()
+{
+#if __linux__
+    if (g_memarea_mmap) {
+        munmap(g_memarea, g_memsize);
+        return;
+    }
+#endif
+    free(g_memarea);
+}
+
+// -----------------------------------------------------------------------------
+// --- NUMA Memory Placement
+
+enum numa_mode_type { NUMA_NONE, NUMA_LOCAL, NUMA_INTERLEAVE, NUMA_BIND };
+
+// memory placement selected by command line
+numa_mode_type g_numa_mode = NUMA_NONE;
+
+// node to bind memory to in NUMA_BIND mode
+int g_numa_bind_node = 0;
+
+// online NUMA nodes
+std::vector<int> g_numa_nodes;
+
+// NUMA node of each cpu number, -1 if unknown
+std::vector<int> g_cpu_node;
+
+// return NUMA node of a cpu
+static inline int cpu_node(int cpu)
+{
+    if (cpu < 0 || cpu >= (int)g_cpu_node.size()) return -1;
+    return g_cpu_node[cpu];
+}
+
+// output a comma separated list of the NUMA nodes the threads ran on
+static inline std::string threadinfo_cpunodes()
+{
+    std::ostringstream oss;
+    for (size_t i = 0; i < g_threadinfo.size(); ++i)
+        oss << (i ? "," : "") << cpu_node(g_threadinfo[i].cpu);
+    return oss.str();
+}
+
+// return name of the current NUMA placement mode
+static inline std::string numa_mode_name()
+{
+    switch (g_numa_mode) {
+    case NUMA_LOCAL: return "local";
+    case NUMA_INTERLEAVE: return "interleave";
+    case NUMA_BIND: {
+        std::ostringstream oss;
+        oss << g_numa_bind_node;
+        return oss.str();
+    }
+    default: return "none";
+    }
+}
+
+#if __linux__
+
+// memory policies and flags of the mbind() and move_pages() system calls,
+// which are called directly to avoid depending on libnuma.
+static const int PMBW_MPOL_PREFERRED = 1;
+static const int PMBW_MPOL_BIND = 2;
+static const int PMBW_MPOL_INTERLEAVE = 3;
+static const unsigned PMBW_MPOL_MF_MOVE = (1 << 1);
+
+// maximum number of NUMA nodes supported in node masks
+static const unsigned int NUMA_MAXNODES = 1024;
+
+// read NUMA nodes and their cpus from sysfs
+static void detect_numa()
+{
+    std::ifstream in("/sys/devices/system/node/online");
+    std::string line;
+    if (!std::getline(in, line) || !parse_idlist(line.c_str(), g_numa_nodes, NUMA_MAXNODES)) {
+        g_numa_nodes.clear();
+        return;
+    }
+
+    for (size_t i = 0; i < g_numa_nodes.size(); ++i)
+    {
+        char path[256];
+        snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", g_numa_nodes[i]);
+
+        std::ifstream cin(path);
+        std::vector<int> cpus;
+        if (!std::getline(cin, line) || !parse_cpulist(line.c_str(), cpus))
+            continue;
+
+        for (size_t j = 0; j < cpus.size(); ++j)
+        {
+            if (cpus[j] >= (int)g_cpu_node.size())
+                g_cpu_node.resize(cpus[j] + 1, -1);
+            g_cpu_node[cpus[j]] = g_numa_nodes[i];
+        }
+    }
+}
+
+// set memory policy of a range of pages to the given nodes
+static bool numa_mbind(void* addr, size_t len, int mode,
+                       const std::vector<int>& nodes, unsigned flags)
+{
+    unsigned long nodemask[NUMA_MAXNODES / (8 * sizeof(unsigned long))];
+    memset(nodemask, 0, sizeof(nodemask));
+
+    for (size_t i = 0; i < nodes.size(); ++i)
+    {
+        if (nodes[i] < 0 || nodes[i] >= (int)NUMA_MAXNODES) return false;
+        nodemask[nodes[i] / (8 * sizeof(unsigned long))] |=
+            1LU << (nodes[i] % (8 * sizeof(unsigned long)));
+    }
+
+    // mbind() works on whole pages: extend range to page boundaries
+    uintptr_t pagesize = g_pagesize;
+    uintptr_t begin = (uintptr_t)addr & ~(pagesize - 1);
+    uintptr_t end = ((uintptr_t)addr + len + pagesize - 1) & ~(pagesize - 1);
+
+    return syscall(SYS_mbind, begin, end - begin, mode,
+                   nodemask, NUMA_MAXNODES + 1, flags) == 0;
+}
+
+// place the area of a thread on the NUMA node(s) selected by g_numa_mode and
+// touch each page from the calling thread, such that all pages are allocated
+// and first-touch places new pages on the right node.
+static void numa_place(int thread_num, char* area, size_t size)
+{
+    if (g_numa_mode == NUMA_NONE) return;
+
+    std::vector<int> nodes;
+    int mode = PMBW_MPOL_PREFERRED;
+
+    if (g_numa_mode == NUMA_LOCAL) {
+        int node = cpu_node(current_cpu());
+        if (node >= 0) nodes.push_back(node);
+    }
+    else if (g_numa_mode == NUMA_INTERLEAVE) {
+        nodes = g_numa_nodes;
+        mode = PMBW_MPOL_INTERLEAVE;
+    }
+    else if (g_numa_mode == NUMA_BIND) {
+        nodes.push_back(g_numa_bind_node);
+        mode = PMBW_MPOL_BIND;
+    }
+
+    // migrate pages already placed elsewhere by previous tests
+    if (!nodes.empty() && !numa_mbind(area, size, mode, nodes, PMBW_MPOL_MF_MOVE)) {
+        ERR("Error setting NUMA memory policy of thread " << thread_num
+            << ": " << strerror(errno));
+    }
+
+    // first touch
+    size_t pagesize = sysconf(_SC_PAGESIZE);
+    for (size_t off = 0; off < size; off += pagesize)
+        area[off] = 1;
+}
+
+// query the NUMA nodes a sample of pages in an area reside on, return the node
+// holding most of them, or -1 if unknown.
+static int numa_memnode(char* area, size_t size)
+{
+    static const size_t samples = 64;
+
+    size_t pagesize = sysconf(_SC_PAGESIZE);
+    size_t npages = (size + pagesize - 1) / pagesize;
+    size_t count = std::min(samples, npages);
+    if (count == 0) return -1;
+
+    std::vector<void*> pages(count);
+    std::vector<int> status(count, -1);
+
+    for (size_t i = 0; i < count; ++i) {
+        uintptr_t addr = (uintptr_t)(area + (i * npages / count) * pagesize);
+        pages[i] = (void*)(addr & ~(uintptr_t)(pagesize - 1));
+    }
+
+    if (syscall(SYS_move_pages, 0, count, &pages[0], NULL, &status[0], 0) != 0)
+        return -1;
+
+    std::map<int, size_t> nodes;
+    for (size_t i = 0; i < count; ++i) {
+        if (status[i] >= 0) ++nodes[status[i]];
+    }
+
+    int node = -1;
+    for (std::map<int, size_t>::const_iterator it = nodes.begin(); it != nodes.end(); ++it) {
+        if (node < 0 || it->second > nodes[node]) node = it->first;
+    }
+    return node;
+}
+
+#else // !__linux__
+
+static void detect_numa()
+{
+}
+
+static void numa_place(int, char*, size_t)
+{
+}
+
+static int numa_memnode(char*, size_t)
+{
+    return -1;
+}
+
+#endif // __linux__
+
+// parse the NUMA placement option
+static bool parse_numa_mode(const char* value)
+{
+    if (strcmp(value, "local") == 0) {
+        g_numa_mode = NUMA_LOCAL;
+        return true;
+    }
+    if (strcmp(value, "interleave") == 0) {
+        g_numa_mode = NUMA_INTERLEAVE;
+        return true;
+    }
+
+    char* endp;
+    g_numa_bind_node = strtoul(value, &endp, 10);
+    if (!*value || !endp || *endp != 0) return false;
+
+    g_numa_mode = NUMA_BIND;
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+// --- Memory Initialization
+
+// a slice of the memory area touched by one thread
+struct TouchSlice
+{
+    char* begin;
+    size_t size;
+
+    // cpu the touching thread is pinned to, -1 to leave it unpinned
+    int cpu;
+};
+
+static void* touch_slice(void* cookie)
+{
+    TouchSlice* slice = (TouchSlice*)cookie;
+    if (slice->cpu >= 0) pin_cpu(slice->cpu);
+
+    // fill memory with junk, which allocates the physical pages
+    memset(slice->begin, 1, slice->size);
+    return NULL;
+}
+
+// touch the memory area up to extent bytes in parallel on the cpus of the
+// first test thread's NUMA node, such that no page faults occur during
+// measurements and first-touch places the pages on that node. The touched
+// area grows at least geometrically, hence a size sweep starts only a few
+// rounds of threads. With NUMA placement the pages are instead touched by the
+// thread using them.
+static void touch_memarea(size_t extent)
+{
+    if (g_numa_mode != NUMA_NONE || extent <= g_memarea_touched) return;
+
+    extent = std::min<size_t>(g_memsize, std::max(extent, 2 * g_memarea_touched));
+
+    char* begin = g_memarea + g_memarea_touched;
+    size_t size = extent - g_memarea_touched;
+
+    // cpus on the node of the first test thread, or of the calling thread
+    int node = cpu_node(g_cpu_order.empty() ? current_cpu() : g_cpu_order[0]);
+    std::vector<int> cpus;
+    for (size_t i = 0; node >= 0 && i < g_topology.size(); ++i)
+    {
+        if (cpu_node(g_topology[i].cpu) == node)
+            cpus.push_back(g_topology[i].cpu);
+    }
+
+    // slices of at least 64 MiB, aligned to 2 MiB for transparent huge pages
+    static const size_t align = 2 * 1024 * 1024;
+    size_t nthreads = std::max(g_physical_cpus, 1);
+    if (!cpus.empty()) nthreads = std::min(nthreads, cpus.size());
+    nthreads = std::min<size_t>(nthreads, size / (64*1024*1024) + 1);
+    size_t slicesize = (size / nthreads + align - 1) / align * align;
+
+    std::vector<TouchSlice> slices;
+    for (size_t offset = 0; offset < size; offset += slicesize)
+    {
+        int cpu = cpus.empty() ? -1 : cpus[slices.size() % cpus.size()];
+        TouchSlice s = { begin + offset, std::min(slicesize, size - offset), cpu };
+        slices.push_back(s);
+    }
+
+    // slices whose thread could not be started are touched by the caller
+    std::vector<pthread_t> threads(slices.size());
+    std::vector<bool> started(slices.size());
+    for (size_t i = 0; i < slices.size(); ++i)
+    {
+        started[i] = (pthread_create(&threads[i], NULL, touch_slice, &slices[i]) == 0);
+        if (!started[i]) {
+            slices[i].cpu = -1;
+            touch_slice(&slices[i]);
+        }
+    }
+
+    for (size_t i = 0; i < slices.size(); ++i)
+    {
+        if (started[i]) pthread_join(threads[i], NULL);
+    }
+
+    g_memarea_touched = extent;
+
+#if __linux__
+    if (gopt_hugepages && strcmp(gopt_hugepages, "thp") == 0) {
+        ERR("Transparent huge pages back " << thp_backed_bytes() / 1024/1024
+            << " MiB of the memory area, " << g_memarea_touched / 1024/1024 << " MiB are touched.");
+    }
+#endif
+}
+
+// -----------------------------------------------------------------------------
+// --- Result Output
+
+// names of the counted hardware events prefixed with perf_, defined with the
+// performance counters below
+static const std::vector<std::string>& perf_field_names();
+
+// all fields of result records in output order, with the perf fields between
+// these. JSON Lines and CSV output always contain all of them, such that their
+// schema does not depend on the mode or options. Text output contains only the
+// fields set in each record.
+static const char* result_fields_head[] = {
+    "datetime", "host", "version", "cpumodel", "kernel", "compiler", "compileropts",
+    "cachesizes", "cachesharing",
+    "mode", "funcname", "nthreads", "streams", "chains",
+    "areasize", "threadsize", "testsize", "repeats", "testvol", "testaccess",
+    "time", "bandwidth", "rate", "timer", "counterhz", "cycles_per_access",
+    "barrier", "affinity", "cpus", "numa", "cpunodes", "hugepages", "pagesize", "thpbytes", "memnodes",
+    "stride", "linebandwidth", "addresses", "pages",
+    "threadbandwidth", "skew", "barrierwait",
+    "loadfunc", "delay", "loadsize", "loadbandwidth",
+    NULL
+};
+
+static const char* result_fields_tail[] = {
+    "trials",
+    "bandwidth_min", "bandwidth_median", "bandwidth_mean", "bandwidth_stddev", "bandwidth_ci95",
+    "rate_min", "rate_median", "rate_mean", "rate_stddev", "rate_ci95",
+    NULL
+};
+
+static std::vector<const char*> make_result_fields()
+{
+    std::vector<const char*> fields;
+    for (size_t f = 0; result_fields_head[f]; ++f)
+        fields.push_back(result_fields_head[f]);
+    for (size_t e = 0; e < perf_field_names().size(); ++e)
+        fields.push_back(perf_field_names()[e].c_str());
+    for (size_t f = 0; result_fields_tail[f]; ++f)
+        fields.push_back(result_fields_tail[f]);
+    return fields;
+}
+
+static const std::vector<const char*>& result_fields()
+{
+    static const std::vector<const char*> fields = make_result_fields();
+    return fields;
+}
+
+// one result of a test as key-value fields in output order
+class ResultRecord
+{
+public:
+    // type of a field value, used for JSON output
+    enum Kind { STRING, NUMBER, LIST };
+
+    // add a string field
+    ResultRecord& str(const char* key, const std::string& value)
+    {
+        m_fields.push_back(Field(key, value, STRING));
+        return *this;
+    }
+
+    // add a numeric field
+    template <typename Type>
+    ResultRecord& num(const char* key, const Type& value)
+    {
+        std::ostringstream oss;
+        oss << std::setprecision(20) << value;
+        m_fields.push_back(Field(key, oss.str(), NUMBER));
+        return *this;
+    }
+
+    // add a field containing a comma-separated list of numbers
+    ResultRecord& list(const char* key, const std::string& value)
+    {
+        m_fields.push_back(Field(key, value, LIST));
+        return *this;
+    }
+
+    // RESULT line with tab-separated key=value pairs, as read by stats2gnuplot
+    std::string txt() const
+    {
+        std::ostringstream oss;
+        oss << "RESULT";
+        for (size_t i = 0; i < m_fields.size(); ++i)
+            oss << '\t' << m_fields[i].key << '=' << m_fields[i].value;
+        return oss.str();
+    }
+
+    // JSON object with all result_fields, null if not set
+    std::string jsonl() const
+    {
+        std::ostringstream oss;
+        oss << '{';
+        const std::vector<const char*>& fields = result_fields();
+        for (size_t f = 0; f < fields.size(); ++f)
+        {
+            oss << (f ? "," : "") << '"' << fields[f] << "\":";
+
+            const Field* field = find(fields[f]);
+            if (!field)
+                oss << "null";
+            else if (field->kind == NUMBER)
+                oss << json_number(field->value);
+            else if (field->kind == LIST)
+            {
+                oss << '[';
+                std::string::size_type begin = 0, end;
+                do {
+                    end = field->value.find(',', begin);
+                    oss << (begin ? "," : "")
+                        << json_number(field->value.substr(begin, end - begin));
+                    begin = end + 1;
+                } while (end != std::string::npos);
+                oss << ']';
+            }
+            else
+                oss << json_string(field->value);
+        }
+        oss << '}';
+        return oss.str();
+    }
+
+    // CSV header line of result_fields
+    static std::string csv_header()
+    {
+        std::ostringstream oss;
+        const std::vector<const char*>& fields = result_fields();
+        for (size_t f = 0; f < fields.size(); ++f)
+            oss << (f ? "," : "") << fields[f];
+        return oss.str();
+    }
+
+    // CSV line with all result_fields, empty if not set
+    std::string csv() const
+    {
+        std::ostringstream oss;
+        const std::vector<const char*>& fields = result_fields();
+        for (size_t f = 0; f < fields.size(); ++f)
+        {
+            if (f) oss << ',';
+
+            const Field* field = find(fields[f]);
+            if (!field) continue;
+
+            if (field->value.find_first_of(",\"\n") == std::string::npos) {
+                oss << field->value;
+                continue;
+            }
+
+            // quote value, doubling quotes
+            oss << '"';
+            for (size_t i = 0; i < field->value.size(); ++i) {
+                if (field->value[i] == '"') oss << '"';
+                oss << field->value[i];
+            }
+            oss << '"';
+        }
+        return oss.str();
+    }
+
+protected:
+    struct Field
+    {
+        const char* key;
+        std::string value;
+        Kind kind;
+
+        Field(const char* k, const std::string& v, Kind t)
+            : key(k), value(v), kind(t) { }
+    };
+
+    // fields in the order they were added
+    std::vector<Field> m_fields;
+
+    // return field with key or NULL
+    const Field* find(const char* key) const
+    {
+        for (size_t i = 0; i < m_fields.size(); ++i) {
+            if (strcmp(m_fields[i].key, key) == 0) return &m_fields[i];
+        }
+        return NULL;
+    }
+
+    // a number as JSON, which has no representation of inf and nan
+    static std::string json_number(const std::string& value)
+    {
+        char* endp;
+        double v = strtod(value.c_str(), &endp);
+        if (value.empty() || *endp != 0 || !isfinite(v)) return "null";
+        return value;
+    }
+
+    // a string as JSON with escaped special characters
+    static std::string json_string(const std::string& value)
+    {
+        std::ostringstream oss;
+        oss << '"';
+        for (size_t i = 0; i < value.size(); ++i)
+        {
+            unsigned char c = value[i];
+            if (c == '"' || c == '\\')
+                oss << '\\' << c;
+            else if (c < 0x20) {
+                char esc[8];
+                snprintf(esc, sizeof(esc), "\\u%04x", c);
+                oss << esc;
+            }
+            else
+                oss << c;
+        }
+        oss << '"';
+        return oss.str();
+    }
+};
+
+// output file of results, kept open during the whole run
+std::ofstream g_resultfile;
+
+// description of the system added to each result
+std::string g_cpumodel = "unknown", g_kernel = "unknown";
+
+// comma-separated capacities and sharing cpus of the detected cache levels
+std::string g_cachesizes, g_cachesharing;
+
+// read cpu model and operating system kernel version
+static void detect_system_info()
+{
+#if __linux__
+    std::ifstream cpuinfo("/proc/cpuinfo");
+    std::string line;
+    while (std::getline(cpuinfo, line))
+    {
+        if (line.compare(0, 10, "model name") != 0) continue;
+
+        std::string::size_type colon = line.find(':');
+        if (colon != std::string::npos && colon + 2 <= line.size()) {
+            g_cpumodel = line.substr(colon + 2);
+            break;
+        }
+    }
+#endif
+
+#if !ON_WINDOWS
+    struct utsname uts;
+    if (uname(&uts) == 0)
+        g_kernel = std::string(uts.sysname) + " " + uts.release;
+#else
+    g_kernel = "Windows";
+#endif
+}
+
+// compiler options which can be seen in predefined macros. The actual
+// compiler flags are not available to the program.
+static std::string compiler_options()
+{
+    std::string opts;
+#ifdef __OPTIMIZE__
+    opts += ",optimize";
+#endif
+#ifdef __OPTIMIZE_SIZE__
+    opts += ",optimize_size";
+#endif
+#ifdef __FAST_MATH__
+    opts += ",fast_math";
+#endif
+#ifdef __PIC__
+    opts += ",pic";
+#endif
+#ifdef __AVX512F__
+    opts += ",avx512f";
+#endif
+#ifdef __AVX2__
+    opts += ",avx2";
+#endif
+#ifdef __AVX__
+    opts += ",avx";
+#endif
+#ifdef __SSE4_2__
+    opts += ",sse4.2";
+#endif
+#ifdef __ARM_NEON
+    opts += ",neon";
+#endif
+    return opts.empty() ? "none" : opts.substr(1);
+}
+
+// add the fields describing date, host, system and compiler to a record
+static void result_add_header(ResultRecord& r)
+{
+    char datetime[64];
+    time_t tnow = time(NULL);
+    strftime(datetime, sizeof(datetime), "%Y-%m-%d %H:%M:%S", localtime(&tnow));
+
+#ifdef __VERSION__
+    const char* compiler = __VERSION__;
+#else
+    const char* compiler = "unknown";
+#endif
+
+    r.str("datetime", datetime)
+        .str("host", g_hostname)
+        .str("version", PACKAGE_VERSION)
+        .str("cpumodel", g_cpumodel)
+        .str("kernel", g_kernel)
+        .str("compiler", compiler)
+        .str("compileropts", compiler_options());
+
+    if (!g_cachesizes.empty())
+        r.list("cachesizes", g_cachesizes).list("cachesharing", g_cachesharing);
+}
+
+// open the output file, truncating it, and write the CSV header
+static bool open_resultfile()
+{
+    g_resultfile.open(gopt_output_file, std::ios::out | std::ios::trunc);
+    if (!g_resultfile.good()) return false;
+
+    if (strcmp(gopt_format, "csv") == 0)
+        g_resultfile << ResultRecord::csv_header() << '\n';
+
+    return true;
+}
+
+// print a RESULT line and write the record to the output file
+static void output_result(const ResultRecord& r)
+{
+    std::cout << r.txt() << std::endl;
+
+    if (strcmp(gopt_format, "jsonl") == 0)
+        g_resultfile << r.jsonl() << '\n';
+    else if (strcmp(gopt_format, "csv") == 0)
+        g_resultfile << r.csv() << '\n';
+    else
+        g_resultfile << r.txt() << '\n';
+}
+
+// -----------------------------------------------------------------------------
+// --- Hardware Performance Counters
+
+// capture hardware performance counters around each test function call
+bool gopt_perf = false;
+
+#if __linux__
+
+// hardware events counted per thread
+struct PerfEvent
+{
+    const char* name;
+    uint32_t type;
+    uint64_t config;
+};
+
+#define PMBW_HW_CACHE(cache, op, result)                                \
+    (PERF_COUNT_HW_CACHE_##cache | (PERF_COUNT_HW_CACHE_OP_##op << 8) | \
+     (PERF_COUNT_HW_CACHE_RESULT_##result << 16))
+
+static const PerfEvent g_perf_events[] = {
+    { "cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+    { "instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+    { "l1d_misses", PERF_TYPE_HW_CACHE, PMBW_HW_CACHE(L1D, READ, MISS) },
+    { "llc_misses", PERF_TYPE_HW_CACHE, PMBW_HW_CACHE(LL, READ, MISS) },
+    { "dtlb_misses", PERF_TYPE_HW_CACHE, PMBW_HW_CACHE(DTLB, READ, MISS) },
+    { "l1d_prefetches", PERF_TYPE_HW_CACHE, PMBW_HW_CACHE(L1D, PREFETCH, ACCESS) },
+};
+
+#undef PMBW_HW_CACHE
+
+static const size_t g_perf_nevents = sizeof(g_perf_events) / sizeof(g_perf_events[0]);
+
+static std::vector<std::string> make_perf_field_names()
+{
+    std::vector<std::string> names;
+    for (size_t e = 0; e < g_perf_nevents; ++e)
+        names.push_back(std::string("perf_") + g_perf_events[e].name);
+    return names;
+}
+
+static const std::vector<std::string>& perf_field_names()
+{
+    static const std::vector<std::string> names = make_perf_field_names();
+    return names;
+}
+
+// events which could be opened at startup
+bool g_perf_available[sizeof(g_perf_events) / sizeof(g_perf_events[0])];
+
+// open a counter for an event on the calling thread, initially disabled
+static int perf_open_event(const PerfEvent& ev)
+{
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = ev.type;
+    attr.config = ev.config;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+    return syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+// check which events can be counted, e.g. VMs often provide none
+static void perf_detect()
+{
+    ERRX("Performance counters:");
+    size_t available = 0;
+
+    for (size_t e = 0; e < g_perf_nevents; ++e)
+    {
+        int fd = perf_open_event(g_perf_events[e]);
+        g_perf_available[e] = (fd >= 0);
+        if (fd < 0) continue;
+
+        close(fd);
+        ERRX(" " << g_perf_events[e].name);
+        ++available;
+    }
+
+    if (available == 0) {
+        ERRX(" none (" << strerror(errno) << "), disabling -E");
+        gopt_perf = false;
+    }
+    ERR("");
+}
+
+// open the counters of a thread, each one individually such that a missing
+// event does not disable the others.
+static void perf_open(int thread_num)
+{
+    if (!gopt_perf) return;
+
+    ThreadInfo& ti = g_threadinfo[thread_num];
+    ti.perf_fd.assign(g_perf_nevents, -1);
+
+    for (size_t e = 0; e < g_perf_nevents; ++e)
+    {
+        if (g_perf_available[e])
+            ti.perf_fd[e] = perf_open_event(g_perf_events[e]);
+    }
+}
+
+// reset and start the counters of a thread
+static inline void perf_start(int thread_num)
+{
+    if (!gopt_perf) return;
+
+    ThreadInfo& ti = g_threadinfo[thread_num];
+    for (size_t e = 0; e < ti.perf_fd.size(); ++e)
+    {
+        if (ti.perf_fd[e] < 0) continue;
+        ioctl(ti.perf_fd[e], PERF_EVENT_IOC_RESET, 0);
+        ioctl(ti.perf_fd[e], PERF_EVENT_IOC_ENABLE, 0);
+    }
+}
+
+// stop the counters of a thread and read them, scaled up if the kernel had
+// to multiplex the counters. Unavailable counts are set to -1.
+static inline void perf_stop(int thread_num)
+{
+    if (!gopt_perf) return;
+
+    ThreadInfo& ti = g_threadinfo[thread_num];
+    ti.perf_count.assign(g_perf_nevents, -1);
+
+    for (size_t e = 0; e < ti.perf_fd.size(); ++e)
+    {
+        if (ti.perf_fd[e] < 0) continue;
+        ioctl(ti.perf_fd[e], PERF_EVENT_IOC_DISABLE, 0);
+
+        // value, time enabled, time running
+        uint64_t data[3];
+        if (read(ti.perf_fd[e], data, sizeof(data)) != sizeof(data) || data[2] == 0)
+            continue;
+
+        ti.perf_count[e] = (double)data[0] * data[1] / data[2];
+    }
+}
+
+static void perf_close(int thread_num)
+{
+    if (!gopt_perf) return;
+
+    ThreadInfo& ti = g_threadinfo[thread_num];
+    for (size_t e = 0; e < ti.perf_fd.size(); ++e)
+    {
+        if (ti.perf_fd[e] >= 0) close(ti.perf_fd[e]);
+    }
+    ti.perf_fd.clear();
+}
+
+// add the counts summed over all measuring threads as result fields,
+// leaving out events not counted by all of them. Load threads in loaded
+// latency mode are not counted.
+static void perf_result(ResultRecord& r)
+{
+    if (!gopt_perf) return;
+
+    size_t nthreads = g_loadfunc ? 1 : g_threadinfo.size();
+
+    for (size_t e = 0; e < g_perf_nevents; ++e)
+    {
+        int64_t sum = 0;
+        for (size_t p = 0; p < nthreads && sum >= 0; ++p)
+        {
+            const ThreadInfo& ti = g_threadinfo[p];
+            if (e >= ti.perf_count.size() || ti.perf_count[e] < 0)
+                sum = -1;
+            else
+                sum += ti.perf_count[e];
+        }
+        if (sum >= 0)
+            r.num(perf_field_names()[e].c_str(), sum);
+    }
+}
+
+#else // !__linux__
+
+static const std::vector<std::string>& perf_field_names()
+{
+    static const std::vector<std::string> names;
+    return names;
+}
+
+static void perf_detect()
+{
+    ERR("Performance counters are not supported on this platform.");
+    gopt_perf = false;
+}
+
+static void perf_open(int)
+{
+}
+
+static inline void perf_start(int)
+{
+}
+
+static inline void perf_stop(int)
+{
+}
+
+static void perf_close(int)
+{
+}
+
+static void perf_result(ResultRecord&)
+{
+}
+
+#endif // __linux__
+
+// -----------------------------------------------------------------------------
+// --- Cache Hierarchy Detection
+
+// one data or unified cache level as seen from the first allowed cpu
+struct CacheLevel
+{
+    int level;
+
+    // capacity and line size in bytes, and number of cpus sharing one cache
+    uint64_t size;
+    unsigned int linesize, ways, sharing;
+};
+
+// detected data and unified caches, ordered by level
+std::vector<CacheLevel> g_caches;
+
+#if __linux__
+
+// read cache levels of a cpu from /sys/devices/system/cpu/cpuN/cache
+static bool detect_caches_sysfs(int cpu)
+{
+    for (int index = 0; ; ++index)
+    {
+        char path[256], value[256];
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/cache/index%d/", cpu, index);
+        std::string dir = path;
+
+        std::ifstream type((dir + "type").c_str());
+        if (!type.getline(value, sizeof(value))) break;
+        if (strcmp(value, "Data") != 0 && strcmp(value, "Unified") != 0) continue;
+
+        CacheLevel c;
+        c.level = read_file_int((dir + "level").c_str());
+
+        // size is given like "48K"
+        std::ifstream size((dir + "size").c_str());
+        if (!size.getline(value, sizeof(value)) || !parse_uint64t(value, c.size))
+            continue;
+
+        c.linesize = std::max(read_file_int((dir + "coherency_line_size").c_str()), 0);
+        c.ways = std::max(read_file_int((dir + "ways_of_associativity").c_str()), 0);
+
+        std::vector<int> cpus;
+        std::ifstream shared((dir + "shared_cpu_list").c_str());
+        if (shared.getline(value, sizeof(value)) && parse_cpulist(value, cpus))
+            c.sharing = cpus.size();
+        else
+            c.sharing = 1;
+
+        if (c.level > 0 && c.size > 0)
+            g_caches.push_back(c);
+    }
+
+    return !g_caches.empty();
+}
+
+#else // !__linux__
+
+static bool detect_caches_sysfs(int)
+{
+    return false;
+}
+
+#endif // __linux__
+
+#if defined(__i386__) || defined (__x86_64__)
+
+// read deterministic cache parameters from CPUID leaf 4
+static bool detect_caches_cpuid()
+{
+    int op0[4];
+    cpuid(0, op0);
+    if (op0[0] < 4) return false;
+
+    for (int index = 0; ; ++index)
+    {
+        int r[4];
+        cpuid_count(4, index, r);
+
+        // cache type: 0 = no more caches, 1 = data, 2 = instruction, 3 = unified
+        int type = r[0] & 0x1F;
+        if (type == 0) break;
+        if (type == 2) continue;
+
+        CacheLevel c;
+        c.level = (r[0] >> 5) & 0x7;
+        c.sharing = ((r[0] >> 14) & 0xFFF) + 1;
+        c.linesize = (r[1] & 0xFFF) + 1;
+        c.ways = ((r[1] >> 22) & 0x3FF) + 1;
+        uint64_t partitions = ((r[1] >> 12) & 0x3FF) + 1;
+        uint64_t sets = (uint32_t)r[2] + 1;
+        c.size = c.ways * partitions * c.linesize * sets;
+
+        g_caches.push_back(c);
+    }
+
+    return !g_caches.empty();
+}
+
+#else
+
+static bool detect_caches_cpuid()
+{
+    return false;
+}
+
+#endif
+
+// detect the cache hierarchy via sysfs, or CPUID if sysfs is unavailable
+static void detect_caches()
+{
+    g_caches.clear();
+
+    int cpu = g_topology.empty() ? 0 : g_topology[0].cpu;
+    if (!detect_caches_sysfs(cpu))
+        detect_caches_cpuid();
+
+    if (g_caches.empty()) {
+        ERR("Could not detect cache sizes.");
+        return;
+    }
+
+    std::ostringstream sizes, sharing;
+
+    ERRX("Caches:");
+    for (size_t i = 0; i < g_caches.size(); ++i)
+    {
+        const CacheLevel& c = g_caches[i];
+        ERRX(" L" << c.level << ' ' << c.size / 1024 << " KiB");
+        if (c.sharing > 1) ERRX(" (" << c.sharing << " cpus)");
+
+        sizes << (i ? "," : "") << c.size;
+        sharing << (i ? "," : "") << c.sharing;
+    }
+    ERR("");
+
+    g_cachesizes = sizes.str();
+    g_cachesharing = sharing.str();
+}
+
+// -----------------------------------------------------------------------------
+// --- List of Array Sizes to Test
+
+const uint64_t areasize_list[] = {
+    1 * 1024,                   // 1 KiB
+    2 * 1024,
+    3 * 1024,
+    4 * 1024,
+    6 * 1024,
+    8 * 1024,
+    12 * 1024,
+    16 * 1024,
+    20 * 1024,
+    24 * 1024,
+    28 * 1024,
+    32 * 1024,
+    40 * 1024,
+    48 * 1024,
+    64 * 1024,
+    96 * 1024,
+    128 * 1024,
+    192 * 1024,
+    256 * 1024,
+    384 * 1024,
+    512 * 1024,
+    768 * 1024,
+    1024 * 1024,                // 1 MiB
+    (1024 + 256) * 1024,	// 1.25 MiB
+    (1024 + 512) * 1024,	// 1.5 MiB
+    (1024 + 768) * 1024,	// 1.75 MiB
+    2048 * 1024,                // 2 MiB = common L2 cache size
+    (2048 + 256) * 1024,	// 2.25
+    (2048 + 512) * 1024,	// 2.5
+    (2048 + 768) * 1024,	// 2.75
+    3 * 1024 * 1024,            // 3 MiB = common L2 cache size
+    4 * 1024 * 1024,            // 4 MiB
+    5 * 1024 * 1024,            // 5 MiB
+    6 * 1024 * 1024,            // 6 MiB = common L2 cache size
+    7 * 1024 * 1024,            // 7 MiB
+    8 * 1024 * 1024,            // 8 MiB = common L2 cache size
+    9 * 1024 * 1024,
+    10 * 1024 * 1024,
+    12 * 1024 * 1024,
+    14 * 1024 * 1024,
+    16 * 1024 * 1024,
+    20 * 1024 * 1024,
+    24 * 1024 * 1024,
+    28 * 1024 * 1024,
+    32 * 1024 * 1024,
+    40 * 1024 * 1024,
+    48 * 1024 * 1024,
+    56 * 1024 * 1024,
+    64 * 1024 * 1024,
+    128 * 1024 * 1024,
+    256 * 1024 * 1024,
+    512 * 1024 * 1024,
+    1 * 1024 * 1024 * 1024LLU,          // 1 GiB
+    2 * 1024 * 1024 * 1024LLU,
+    4 * 1024 * 1024 * 1024LLU,
+    8 * 1024 * 1024 * 1024LLU,
+    16 * 1024 * 1024 * 1024LLU,
+    32 * 1024 * 1024 * 1024LLU,
+    64 * 1024 * 1024 * 1024LLU,
+    128 * 1024 * 1024 * 1024LLU,
+    256 * 1024 * 1024 * 1024LLU,
+    512 * 1024 * 1024 * 1024LLU,
+    1024 * 1024 * 1024 * 1024LLU,       // 1 TiB
+    0   // list termination
+};
+
+// sample the array sizes densely around cache boundaries with -A
+bool gopt_adaptive_sizes = false;
+
+// total capacity of a cache level available to nthreads threads, assuming
+// they fill the cpus sharing one cache before using the next one.
+static uint64_t cache_capacity(const CacheLevel& c, int nthreads)
+{
+    uint64_t instances = std::max<uint64_t>(1, g_physical_cpus / c.sharing);
+    uint64_t used = (nthreads + c.sharing - 1) / c.sharing;
+
+    return c.size * std::min(used, instances);
+}
+
+// make the list of array sizes tested with nthreads threads. Without -A this
+// is areasize_list. The adaptive list samples each factor of two once and
+// adds 8 steps per factor of two from half to twice of each cache capacity
+// reachable by the threads, hence about as many sizes as areasize_list.
+static std::vector<uint64_t> make_areasizes(int nthreads)
+{
+    std::vector<uint64_t> sizes;
+
+    if (!gopt_adaptive_sizes || g_caches.empty())
+    {
+        for (const uint64_t* areasize = areasize_list; *areasize; ++areasize)
+            sizes.push_back(*areasize);
+        return sizes;
+    }
+
+    // sparse samples at powers of two
+    for (uint64_t s = 1024; s <= 1024 * 1024 * 1024 * 1024LLU; s *= 2)
+        sizes.push_back(s);
+
+    // dense samples around each cache boundary, rounded to 1 KiB
+    for (size_t i = 0; i < g_caches.size(); ++i)
+    {
+        double capacity = cache_capacity(g_caches[i], nthreads);
+
+        for (int step = -8; step <= 8; ++step)
+        {
+            uint64_t s = capacity * pow(2.0, step / 8.0);
+            s = (s + 512) / 1024 * 1024;
+            if (s >= 1024) sizes.push_back(s);
+        }
+    }
+
+    std::sort(sizes.begin(), sizes.end());
+    sizes.erase(std::unique(sizes.begin(), sizes.end()), sizes.end());
+
+    return sizes;
+}
+
+// -----------------------------------------------------------------------------
+// --- Main Program
+
+// flag for terminating current test
+bool g_done;
+
+// global current number of threads
+int g_nthreads = 0;
+
+// synchronization barrier for current thread counter
+pthread_barrier_t g_barrier;
+
+// barrier implementation: "pthread" or "spin"
+const char* gopt_barrier = "pthread";
+
+// Sense-reversing spin barrier: the last thread to arrive resets the counter
+// and flips the generation, on which all other threads spin. Counter and
+// generation lie on separate cache lines.
+struct SpinBarrier
+{
+    unsigned int nthreads;
+    unsigned int spinlimit;
+    char pad0[64];
+    volatile unsigned int count;
+    char pad1[64];
+    volatile unsigned int generation;
+    char pad2[64];
+
+    void init(unsigned int n, unsigned int spins)
+    {
+        nthreads = n;
+        spinlimit = spins;
+        count = 0;
+        generation = 0;
+    }
+
+    void wait()
+    {
+        unsigned int gen = generation;
+
+        if (__sync_add_and_fetch(&count, 1) == nthreads)
+        {
+            count = 0;
+            __sync_synchronize();
+            generation = gen + 1;
+            return;
+        }
+
+        // spin politely, but yield the cpu if the other threads do not
+        // arrive soon.
+        for (unsigned int spins = 0; generation == gen; ++spins)
+        {
+            if (spins < spinlimit)
+                cpu_relax();
+            else
+                sched_yield();
+        }
+        __sync_synchronize();
+    }
+
+    static inline void cpu_relax()
+    {
+#if defined(__i386__) || defined(__x86_64__)
+        asm volatile("pause" ::: "memory");
+#elif defined(__aarch64__) || defined(__arm__)
+        asm volatile("yield" ::: "memory");
+#else
+        asm volatile("" ::: "memory");
+#endif
+    }
+};
+
+SpinBarrier g_spin_barrier;
+
+static inline bool use_spin_barrier()
+{
+    return gopt_barrier[0] == 's';
+}
+
+// initialize the barrier of the selected implementation for n threads
+static void barrier_init(unsigned int n)
+{
+    // with more threads than cpus, spinning only delays the others
+    if (use_spin_barrier())
+        g_spin_barrier.init(n, ((int)n <= g_physical_cpus) ? 4096 : 16);
+    else
+        pthread_barrier_init(&g_barrier, NULL, n);
+}
+
+// wait until all threads arrived at the barrier
+static inline void barrier_wait()
+{
+    if (use_spin_barrier())
+        g_spin_barrier.wait();
+    else
+        pthread_barrier_wait(&g_barrier);
+}
+
+static void barrier_destroy()
+{
+    if (!use_spin_barrier())
+        pthread_barrier_destroy(&g_barrier);
+}
+
+// thread shared parameters for test function
+uint64_t g_thrsize;
+uint64_t g_thrsize_spaced;
+uint64_t g_repeats;
+
+// draw a random number in [0,n) using a multiply-high instead of a modulo
+static inline size_t random_below(LCGRandom& rnd, size_t n)
+{
+#if defined(__SIZEOF_INT128__)
+    return (size_t)(((unsigned __int128)rnd() * n) >> 64);
+#else
+    return rnd() % n;
+#endif
+}
+
+// One part of a cyclic permutation: each chain owns the cache lines with
+// index = chain (mod chains), and each of its helper parts owns the pointers
+// with word = helper (mod helpers) in all of the chain's lines. Hence every
+// part spans all lines of its chain, and walking the parts one after another
+// still reuses each line only after visiting all others.
+struct PermutationPart
+{
+    void** ptrarray;
+    size_t size;                // total number of pointers in ptrarray
+    size_t chains, chain;
+    size_t helpers, helper;     // helpers divides linewords
+
+    // number of pointers in a cache line
+    static const size_t linewords = 64 / sizeof(void*);
+
+    // position in ptrarray of the k-th pointer of this part
+    size_t pos(size_t k) const
+    {
+        size_t partwords = linewords / helpers;
+        return ((k / partwords) * chains + chain) * linewords
+            + (k % partwords) * helpers + helper;
+    }
+
+    // number of pointers in this part
+    size_t count() const
+    {
+        size_t partwords = linewords / helpers;
+        size_t lines = size / linewords, rest = size % linewords;
+        size_t cnt = (lines > chain) ? (lines - chain + chains - 1) / chains * partwords : 0;
+        if (lines >= chain && (lines - chain) % chains == 0 && rest > helper)
+            cnt += (rest - helper + helpers - 1) / helpers;
+        return cnt;
+    }
+};
+
+// permute the pointers of one part into a single cycle using Sattolo's
+// algorithm. The random swap positions are drawn some steps ahead and
+// prefetched, which hides most of the cache misses on large areas.
+static void* permute_part(void* cookie)
+{
+    const PermutationPart& pp = *(const PermutationPart*)cookie;
+    void** ptrarray = pp.ptrarray;
+
+    size_t size = pp.count();
+
+    for (size_t k = 0; k < size; ++k)
+    {
+        // fill area with pointers to self-address
+        ptrarray[pp.pos(k)] = &ptrarray[pp.pos(k)];
+    }
+
+    size_t part = pp.helper * pp.chains + pp.chain;
+    LCGRandom srnd((size_t)ptrarray + 233349568 + part * 0x9E3779B97F4A7C15LLU);
+
+    // ring of swap positions drawn ahead, slot n % ahead holds position for n
+    static const size_t ahead = 16;
+    size_t swappos[ahead];
+
+    for (size_t n = size; n > 1 && n + ahead > size; --n)
+        swappos[n % ahead] = random_below(srnd, n-1);
+
+    for (size_t n = size; n > 1; --n)
+    {
+        size_t i = swappos[n % ahead];
+
+        if (n > ahead + 1)
+        {
+            size_t j = random_below(srnd, n - ahead - 1);
+            swappos[n % ahead] = j;
+            __builtin_prefetch(&ptrarray[pp.pos(j)], 1);
+        }
+
+        std::swap( ptrarray[pp.pos(i)], ptrarray[pp.pos(n-1)] );
+    }
+
+    return NULL;
+}
+
+// helper thread permuting one part, it may run on any cpu
+static void* permute_helper(void* cookie)
+{
+    unpin_thread();
+    return permute_part(cookie);
+}
+
+// Create a one-cycle permutation of pointers in the memory area
+void make_cyclic_permutation(int thread_num, void* memarea, size_t bytesize,
+                             unsigned int chains)
+{
+    void** ptrarray = (void**)memarea;
+    size_t size = bytesize / sizeof(void*);
+
+    if (thread_num == 0)
+        (std::cout << "Make permutation:").flush();
+
+    // *** Barrier ****
+    barrier_wait();
+
+    // each chain is one part of cache lines interleaved with the other
+    // chains. Large areas are additionally permuted in parts by helper threads
+    // using the cpus not occupied by test threads. The helper parts split the
+    // pointers of each cache line, hence there are at most linewords of them.
+    size_t helpers = 1;
+    if (size >= 1024 * 1024 && g_physical_cpus > g_nthreads)
+    {
+        size_t spare = std::min<size_t>(g_physical_cpus / g_nthreads, PermutationPart::linewords);
+        while (2 * helpers <= spare) helpers *= 2;
+    }
+
+    size_t parts = chains * helpers;
+
+    if (chains > 1)
+        (std::cout << " chains=" << chains).flush();
+
+    (std::cout << " permuting").flush();
+
+    std::vector<PermutationPart> pp(parts);
+    std::vector<pthread_t> helper(parts);
+
+    for (size_t p = 0; p < parts; ++p)
+    {
+        pp[p].ptrarray = ptrarray, pp[p].size = size;
+        pp[p].chains = chains, pp[p].chain = p % chains;
+        pp[p].helpers = helpers, pp[p].helper = p / chains;
+    }
+
+    // parts whose helper thread could not be created are permuted here
+    std::vector<bool> started(parts, false);
+    for (size_t p = 1; p < parts; ++p)
+        started[p] = (pthread_create(&helper[p], NULL, permute_helper, &pp[p]) == 0);
+
+    for (size_t p = 0; p < parts; ++p) {
+        if (!started[p]) permute_part(&pp[p]);
+    }
+
+    for (size_t p = 1; p < parts; ++p) {
+        if (started[p]) pthread_join(helper[p], NULL);
+    }
+
+    // splice the cycles of the parts of each chain (parts c, c + chains, ...)
+    // into one cycle: the first pointer of each part continues with the
+    // successor of the first pointer of the next part.
+    for (size_t c = 0; c < chains && helpers > 1; ++c)
+    {
+        void* first = ptrarray[pp[c].pos(0)];
+        for (size_t p = c; p + chains < parts; p += chains)
+            ptrarray[pp[p].pos(0)] = ptrarray[pp[p + chains].pos(0)];
+        ptrarray[pp[parts - chains + c].pos(0)] = first;
+    }
+
+    if (gopt_testcycle)
+    {
+        (std::cout << " testing").flush();
+
+        for (size_t c = 0; c < chains; ++c)
+        {
+            void** start = &ptrarray[c * PermutationPart::linewords];
+            void* ptr = *start;
+            size_t steps = 1;
+
+            while ( ptr != start && steps < size*2 )
+            {
+                ptr = *(void**)ptr;         // walk pointer
+                ++steps;
+            }
+            (std::cout << " cycle=" << steps).flush();
+
+            assert(steps == size / chains);
+        }
+    }
+    else
+    {
+        (std::cout << " cycle=" << size / chains).flush();
+    }
+
+    // *** Barrier ****
+    barrier_wait();
+
+    if (thread_num == 0)
+        std::cout << std::endl;
+}
+
+// Fill the arrays of a multi-array test with the initial values of STREAM
+void fill_stream_arrays(void* memarea, size_t arraysize, unsigned int streams)
+{
+    // a = 1.0, b = 2.0, c = 0.0 keeps the kernels free of denormals
+    static const double initval[3] = { 1.0, 2.0, 0.0 };
+
+    for (unsigned int s = 0; s < streams; ++s)
+    {
+        double* array = (double*)((char*)memarea + s * arraysize);
+
+        for (size_t i = 0; i < arraysize / sizeof(double); ++i)
+            array[i] = initval[s % 3];
+    }
+}
+
+// Loaded latency mode: load threads stop when the test function in thread 0
+// finishes
+volatile bool g_load_stop;
+
+// delay between the chunks of the load threads, in empty loop iterations
+int g_load_delay = 0;
+
+// buffer size of each load thread, independent of the probe's array size
+uint64_t g_loadsize = 0;
+
+// size of the chunks the load threads access between delays
+static const size_t g_load_chunk = 4096;
+
+// spin for a number of empty loop iterations
+static inline void delay_loop(int iterations)
+{
+    for (int i = 0; i < iterations; ++i)
+        asm volatile("" ::: "memory");
+}
+
+// buffer size of each of nthreads-1 load threads: -l, or by default four
+// times the last level cache capacity spread over all load threads, such that
+// the load reaches memory, at least 16 MiB each.
+static uint64_t load_size(int nthreads)
+{
+    uint64_t size = gopt_loadsize;
+    if (!size)
+    {
+        size = 64 * 1024 * 1024;
+        if (!g_caches.empty())
+            size = 4 * cache_capacity(g_caches.back(), nthreads) / std::max(nthreads - 1, 1);
+        size = std::max<uint64_t>(size, 16 * 1024 * 1024);
+    }
+    return (size + g_load_chunk - 1) / g_load_chunk * g_load_chunk;
+}
+
+// run the load kernel over the buffer of a thread in chunks, with a delay
+// after each chunk, until the test function in thread 0 finishes.
+static void run_load(int thread_num)
+{
+    char* area = g_memarea + thread_num * g_thrsize_spaced;
+    size_t chunk = std::min<size_t>(g_load_chunk, g_loadsize);
+    uint64_t bytes = 0;
+
+    double ts1 = timestamp();
+
+    while (!g_load_stop)
+    {
+        for (size_t off = 0; off + chunk <= g_loadsize && !g_load_stop; off += chunk)
+        {
+            g_loadfunc->func(area + off, chunk, 1);
+            bytes += chunk * g_loadfunc->bytes_per_access / g_loadfunc->offset();
+            delay_loop(g_load_delay);
+        }
+    }
+
+    g_threadinfo[thread_num].loadbytes = bytes;
+    g_threadinfo[thread_num].loadtime = timestamp() - ts1;
+}
+
+// synchronize with worker threads, run a worker ourselves and return the
+// runtime of one test
+static double master_run(int thread_num)
+{
+    g_done = false;
+    g_load_stop = false;
+
+    // *** Barrier ****
+    barrier_wait();
+
+    assert(!g_done);
+
+    // place memory on NUMA nodes
+    numa_place(thread_num, g_memarea + thread_num * g_thrsize_spaced, g_thrsize);
+
+    // create cyclic permutation for each thread
+    if (g_func->make_permutation)
+        make_cyclic_permutation(thread_num, g_memarea + thread_num * g_thrsize_spaced, g_thrsize, g_func->chains);
+
+    // initialize arrays of multi-array tests
+    if (g_func->streams > 1)
+        fill_stream_arrays(g_memarea + thread_num * g_thrsize_spaced, g_thrsize / g_func->streams, g_func->streams);
+
+    // *** Barrier ****
+    barrier_wait();
+    perf_start(thread_num);
+    double ts1 = timestamp();
+
+    g_func->func(g_memarea + thread_num * g_thrsize_spaced, g_thrsize / g_func->streams, g_repeats);
+    g_threadinfo[thread_num].endtime = timestamp();
+    g_threadinfo[thread_num].runtime = g_threadinfo[thread_num].endtime - ts1;
+    g_load_stop = true;
+    perf_stop(thread_num);
+    g_threadinfo[thread_num].cpu = current_cpu();
+
+    // *** Barrier ****
+    barrier_wait();
+    double ts2 = timestamp();
+
+    // all threads left the barrier at about ts2
+    for (int p = 0; p < g_nthreads; ++p)
+        g_threadinfo[p].barrierwait = ts2 - g_threadinfo[p].endtime;
+
+    return ts2 - ts1;
+}
+
+// statistics over the measurements of several trials
+struct TrialStats
+{
+    double min, median, mean, stddev, ci95;
+
+    explicit TrialStats(std::vector<double> v)
+    {
+        std::sort(v.begin(), v.end());
+        size_t n = v.size();
+
+        min = v[0];
+        median = (n % 2) ? v[n / 2] : (v[n / 2 - 1] + v[n / 2]) / 2;
+
+        mean = 0;
+        for (size_t i = 0; i < n; ++i) mean += v[i];
+        mean /= n;
+
+        stddev = 0;
+        for (size_t i = 0; i < n; ++i) stddev += (v[i] - mean) * (v[i] - mean);
+        stddev = (n > 1) ? sqrt(stddev / (n - 1)) : 0;
+
+        // half width of the 95% confidence interval of the mean, using the
+        // two-sided quantiles of Student's t-distribution
+        static const double tquantile[] = {
+            0, 12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262,
+            2.228, 2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093,
+            2.086, 2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045
+        };
+        double t = (n - 1 < sizeof(tquantile) / sizeof(tquantile[0])) ? tquantile[n - 1] : 1.96;
+        ci95 = (n > 1) ? t * stddev / sqrt((double)n) : 0;
+    }
+};
+
+void* thread_master(void* cookie)
+{
+    // this weirdness is because (void*) cannot be cast to int and back.
+    int thread_num = *((int*)cookie);
+    delete (int*)cookie;
+
+    pin_thread(thread_num);
+    perf_open(thread_num);
+
+    // initial repeat factor is just an approximate B/s bandwidth
+    uint64_t factor = 1024*1024*1024;
+
+    // in loaded latency mode only thread 0 runs the test function, the
+    // others run the load kernel over buffers of fixed size.
+    std::vector<uint64_t> areasizes = make_areasizes(g_loadfunc ? 1 : g_nthreads);
+
+    if (g_loadfunc) {
+        g_loadsize = load_size(g_nthreads);
+        ERR("Load threads access " << g_loadsize << " bytes each.");
+    }
+
+    for (size_t i = 0; i < areasizes.size(); ++i)
+    {
+        uint64_t areasize = areasizes[i];
+
+        if (areasize < gopt_sizelimit_min && gopt_sizelimit_min != 0) {
+            ERR("Skipping " << g_func->name << " test with " << areasize
+                << " minimum array size due to -s " << gopt_sizelimit_min << ".");
+            continue;
+        }
+        if (areasize > gopt_sizelimit_max && gopt_sizelimit_max != 0) {
+            ERR("Skipping " << g_func->name << " test with " << areasize
+                << " maximum array size due to -S " << gopt_sizelimit_max << ".");
+            continue;
+        }
+
+        for (unsigned int round = 0; round < 1; ++round)
+        {
+            // divide area by thread number, except for the single thread
+            // running the test function in loaded latency mode
+            g_thrsize = areasize / (g_loadfunc ? 1 : g_nthreads);
+
+            // strided tests need at least one stride per thread
+            if (g_func->strided && g_thrsize < g_stride) continue;
+
+            // unrolled tests do up to 16 accesses without loop check, thus align
+            // upward to next multiple of unroll_factor*size (e.g. 128 bytes for
+            // 16-times unrolled 64-bit access), and this for each array of
+            // multi-array tests.
+            uint64_t unrollsize = g_func->unroll_factor * g_func->bytes_per_access * g_func->streams;
+            // strided tests access the area at each full stride
+            if (g_func->strided) unrollsize = std::max<uint64_t>(unrollsize, g_stride);
+            g_thrsize = ((g_thrsize + unrollsize - 1) / unrollsize) * unrollsize;
+
+            // total size tested, in loaded latency mode only thread 0 runs
+            // the test function
+            uint64_t testsize = g_thrsize * (g_loadfunc ? 1 : g_nthreads);
+
+            // skip if tests don't fit into memory
+            if (g_memsize < testsize) continue;
+
+            // due to cache thrashing in adjacent cache lines, space out
+            // threads's test areas. Whole pages up to 2 MiB keep each
+            // thread's area on its own huge pages for NUMA placement. With
+            // 1 GiB pages threads may share a page placed on one node, as
+            // spacing by 1 GiB would leave most thread counts no memory.
+            uint64_t spacing = std::min<uint64_t>(g_pagesize, 2*1024*1024);
+            g_thrsize_spaced = std::max<uint64_t>(g_thrsize, 4*1024*1024 + 16*1024);
+            if (g_loadfunc) g_thrsize_spaced = std::max(g_thrsize_spaced, g_loadsize);
+            g_thrsize_spaced = (g_thrsize_spaced + spacing - 1) / spacing * spacing;
+
+            // skip if tests don't fit into memory
+            if (g_memsize < g_thrsize_spaced * g_nthreads)
+            {
+                ERR("Skipping " << g_func->name << " test with " << areasize << " array size and "
+                    << g_nthreads << " threads, their spaced areas need " << g_thrsize_spaced * g_nthreads
+                    << " bytes of " << g_memsize << " bytes allocated.");
+                continue;
+            }
+
+            // fault in the memory used by this test before measuring
+            touch_memarea(g_thrsize_spaced * g_nthreads);
+
+            g_repeats = (factor + g_thrsize-1) / g_thrsize;         // round up
+
+            // volume in bytes tested, the arrays of multi-array tests all lie
+            // within testsize, hence the bytes of each stream are counted.
+            uint64_t testvol = testsize * g_repeats * g_func->bytes_per_access / g_func->offset();
+            // number of accesses in test
+            uint64_t testaccess = testsize * g_repeats / g_func->offset();
+
+            ERR("Running"
+                << " nthreads=" << g_nthreads
+                << " factor=" << factor
+                << " areasize=" << areasize
+                << " thrsize=" << g_thrsize
+                << " testsize=" << testsize
+                << " repeats=" << g_repeats
+                << " testvol=" << testvol
+                << " testaccess=" << testaccess);
+
+            double runtime = master_run(thread_num);
+
+            if ( runtime < g_min_time )
+            {
+                // test ran for less than one second, repeat test and scale
+                // repeat factor
+                factor = g_thrsize * g_repeats * g_avg_time / runtime;
+                ERR("run time = " << runtime << " -> rerunning test with repeat factor=" << factor);
+
+                --round;     // redo this areasize
+            }
+            else
+            {
+                // adapt repeat factor to observed memory bandwidth, so that
+                // next test will take approximately g_avg_time sec
+
+                factor = g_thrsize * g_repeats * g_avg_time / runtime;
+                ERR("run time = " << runtime << " -> next test with repeat factor=" << factor);
+
+                // run further trials until the relative error of the mean
+                // runtime falls below the target. The per-thread information
+                // of each trial is kept to report that of the median one.
+                std::vector<double> runtimes(1, runtime);
+                std::vector< std::vector<ThreadInfo> > trialinfo(1, g_threadinfo);
+
+                while (runtimes.size() < gopt_trials)
+                {
+                    if (gopt_relerr > 0 && runtimes.size() >= 3) {
+                        TrialStats rts(runtimes);
+                        if (rts.ci95 / rts.mean < gopt_relerr) break;
+                    }
+
+                    runtimes.push_back(master_run(thread_num));
+                    trialinfo.push_back(g_threadinfo);
+                    ERR("trial " << runtimes.size() << " run time = " << runtimes.back());
+                }
+
+                // report the median runtime of all trials, and the thread
+                // runtimes and counters of the median trial, the lower one of
+                // an even number of trials.
+                TrialStats rts(runtimes);
+                runtime = rts.median;
+
+                std::vector< std::pair<double, size_t> > order;
+                for (size_t t = 0; t < runtimes.size(); ++t)
+                    order.push_back(std::make_pair(runtimes[t], t));
+                std::sort(order.begin(), order.end());
+                g_threadinfo = trialinfo[order[(order.size() - 1) / 2].second];
+
+                ResultRecord result;
+                result_add_header(result);
+
+                std::ostringstream memnodes;
+                for (int p = 0; p < g_nthreads; ++p) {
+                    memnodes << (p ? "," : "")
+                             << numa_memnode(g_memarea + p * g_thrsize_spaced, g_thrsize);
+                }
+
+                size_t thpbytes;
+                size_t pagesize = backing_pagesize(g_thrsize_spaced * g_nthreads, thpbytes);
+
+                result.str("mode", gopt_mode)
+                    .str("funcname", g_func->name)
+                    .num("nthreads", g_nthreads)
+                    .num("streams", g_func->streams)
+                    .num("chains", g_func->chains)
+                    .num("areasize", areasize)
+                    .num("threadsize", g_thrsize)
+                    .num("testsize", testsize)
+                    .num("repeats", g_repeats)
+                    .num("testvol", testvol)
+                    .num("testaccess", testaccess)
+                    .num("time", runtime)
+                    .num("bandwidth", testvol / runtime)
+                    .num("rate", runtime / testaccess)
+                    .str("timer", gopt_timer)
+                    .num("counterhz", g_cycle_hz)
+                    .num("cycles_per_access", runtime / testaccess * g_cycle_hz)
+                    .str("barrier", gopt_barrier)
+                    .str("affinity", gopt_affinity ? gopt_affinity : "none")
+                    .list("cpus", threadinfo_cpus())
+                    .str("numa", numa_mode_name())
+                    .list("cpunodes", threadinfo_cpunodes())
+                    .str("hugepages", gopt_hugepages ? gopt_hugepages : "none")
+                    .num("pagesize", pagesize)
+                    .list("memnodes", memnodes.str());
+
+                if (gopt_hugepages && strcmp(gopt_hugepages, "thp") == 0)
+                    result.num("thpbytes", thpbytes);
+
+                if (g_func->strided)
+                {
+                    // volume of whole 64 byte cache lines transferred: each
+                    // access touches its own line if the stride is at least a
+                    // line, otherwise all lines of the area are touched.
+                    uint64_t linevol = testsize * g_repeats * std::min<uint64_t>(g_stride, 64) / g_stride;
+
+                    result.num("stride", g_stride)
+                        .num("linebandwidth", linevol / runtime);
+                }
+
+                if (!g_loadfunc)
+                {
+                    // bandwidth of each thread by its own runtime, the ratio
+                    // of the slowest to the fastest thread, and the time each
+                    // thread waited for the slowest one.
+                    uint64_t threadvol = g_thrsize * g_repeats * g_func->bytes_per_access / g_func->offset();
+                    double tmin = g_threadinfo[0].runtime, tmax = g_threadinfo[0].runtime;
+
+                    std::ostringstream threadbandwidth, barrierwait;
+                    threadbandwidth << std::setprecision(20);
+                    barrierwait << std::setprecision(20);
+                    for (int p = 0; p < g_nthreads; ++p) {
+                        threadbandwidth << (p ? "," : "") << threadvol / g_threadinfo[p].runtime;
+                        barrierwait << (p ? "," : "") << g_threadinfo[p].barrierwait;
+                        tmin = std::min(tmin, g_threadinfo[p].runtime);
+                        tmax = std::max(tmax, g_threadinfo[p].runtime);
+                    }
+
+                    result.list("threadbandwidth", threadbandwidth.str())
+                        .num("skew", tmax / tmin)
+                        .list("barrierwait", barrierwait.str());
+                }
+                else
+                {
+                    // sum of the bandwidths of all load threads
+                    double loadbandwidth = 0;
+                    for (int p = 1; p < g_nthreads; ++p) {
+                        if (g_threadinfo[p].loadtime > 0)
+                            loadbandwidth += g_threadinfo[p].loadbytes / g_threadinfo[p].loadtime;
+                    }
+
+                    result.str("loadfunc", g_loadfunc->name)
+                        .num("delay", g_load_delay)
+                        .num("loadsize", g_loadsize)
+                        .num("loadbandwidth", loadbandwidth);
+                }
+
+                perf_result(result);
+
+                if (runtimes.size() > 1)
+                {
+                    std::vector<double> bandwidths, rates;
+                    for (size_t t = 0; t < runtimes.size(); ++t) {
+                        bandwidths.push_back(testvol / runtimes[t]);
+                        rates.push_back(runtimes[t] / testaccess);
+                    }
+                    TrialStats bws(bandwidths), ras(rates);
+
+                    result.num("trials", runtimes.size())
+                        .num("bandwidth_min", bws.min)
+                        .num("bandwidth_median", bws.median)
+                        .num("bandwidth_mean", bws.mean)
+                        .num("bandwidth_stddev", bws.stddev)
+                        .num("bandwidth_ci95", bws.ci95)
+                        .num("rate_min", ras.min)
+                        .num("rate_median", ras.median)
+                        .num("rate_mean", ras.mean)
+                        .num("rate_stddev", ras.stddev)
+                        .num("rate_ci95", ras.ci95);
+                }
+
+                output_result(result);
+            }
+        }
+    }
+
+    g_done = true;
+
+    // *** Barrier ****
+    barrier_wait();
+
+    perf_close(thread_num);
+
+    return NULL;
+}
+
+void* thread_worker(void* cookie)
+{
+    // this weirdness is because (void*) cannot be cast to int and back.
+    int thread_num = *((int*)cookie);
+    delete (int*)cookie;
+
+    pin_thread(thread_num);
+    perf_open(thread_num);
+
+    while (1)
+    {
+        // *** Barrier ****
+        barrier_wait();
+
+        if (g_done) break;
+
+        // place memory on NUMA nodes
+        numa_place(thread_num, g_memarea + thread_num * g_thrsize_spaced,
+                   g_loadfunc ? g_loadsize : g_thrsize);
+
+        if (g_loadfunc)
+        {
+            // load threads skip the permutation, but must pass its barriers
+            if (g_func->make_permutation) {
+                barrier_wait();
+                barrier_wait();
+            }
+
+            // *** Barrier ****
+            barrier_wait();
+
+            run_load(thread_num);
+            g_threadinfo[thread_num].cpu = current_cpu();
+            g_threadinfo[thread_num].endtime = timestamp();
+
+            // *** Barrier ****
+            barrier_wait();
+            continue;
+        }
+
+        // create cyclic permutation for each thread
+        if (g_func->make_permutation)
+            make_cyclic_permutation(thread_num, g_memarea + thread_num * g_thrsize_spaced, g_thrsize, g_func->chains);
+
+        // initialize arrays of multi-array tests
+        if (g_func->streams > 1)
+            fill_stream_arrays(g_memarea + thread_num * g_thrsize_spaced, g_thrsize / g_func->streams, g_func->streams);
+
+        // *** Barrier ****
+        barrier_wait();
+        perf_start(thread_num);
+        double ts1 = timestamp();
+
+        g_func->func(g_memarea + thread_num * g_thrsize_spaced, g_thrsize / g_func->streams, g_repeats);
+        g_threadinfo[thread_num].endtime = timestamp();
+        g_threadinfo[thread_num].runtime = g_threadinfo[thread_num].endtime - ts1;
+        perf_stop(thread_num);
+        g_threadinfo[thread_num].cpu = current_cpu();
+
+        // *** Barrier ****
+        barrier_wait();
+    }
+
+    perf_close(thread_num);
+
+    return NULL;
+}
+
+void testfunc(const TestFunction* func)
+{
+    if (!match_funcfilter(func->name)) {
+        ERR("Skipping " << func->name << " tests");
+        return;
+    }
+
+    int nthreads = 1;
+
+    if (gopt_nthreads_min != 0)
+        nthreads = gopt_nthreads_min;
+
+    if (gopt_nthreads_max == 0)
+        gopt_nthreads_max = g_physical_cpus + 2;
+
+    bool exp_have_physical = false;
+
+    while (1)
+    {
+        // globally set test function and thread number
+        g_func = func;
+        g_nthreads = nthreads;
+
+        // create barrier and run threads
+        barrier_init(nthreads);
+        g_threadinfo.assign(nthreads, ThreadInfo());
+
+        pthread_t thr[nthreads];
+        pthread_create(&thr[0], NULL, thread_master, new int(0));
+        for (int p = 1; p < nthreads; ++p)
+            pthread_create(&thr[p], NULL, thread_worker, new int(p));
 
-            // total size tested
-            uint64_t testsize = g_thrsize * g_nthreads;
+        for (int p = 0; p < nthreads; ++p)
+            pthread_join(thr[p], NULL);
 
-            // skip if tests don't fit into memory
-            if (g_memsize < testsize) continue;
+        barrier_destroy();
 
-            // due to cache thrashing in adjacent cache lines, space out
-            // threads's test areas
-            g_thrsize_spaced = std::max<uint64_t>(g_thrsize, 4*1024*1024 + 16*1024);
+        // increase thread count
+        if (nthreads >= gopt_nthreads_max) break;
 
-            // skip if tests don't fit into memory
-            if (g_memsize < g_thrsize_spaced * g_nthreads) continue;
+        if (gopt_nthreads_exponential)
+            nthreads = 2 * nthreads;
+        else
+            nthreads++;
 
-            g_repeats = (factor + g_thrsize-1) / g_thrsize;         // round up
+        // Prevent the next check from running the tests with g_physical_cpus
+        // twice if that is a power of two
+        if (gopt_nthreads_exponential && nthreads == g_physical_cpus)
+            exp_have_physical = true;
 
-            // volume in bytes tested
-            uint64_t testvol = testsize * g_repeats * g_func->bytes_per_access / g_func->access_offset;
-            // number of accesses in test
-            uint64_t testaccess = testsize * g_repeats / g_func->access_offset;
+        if (gopt_nthreads_exponential && nthreads > g_physical_cpus &&
+            !exp_have_physical) {
+            // Halve it because we want both with and without hyperthreading.
+            // The next iteration will then have nthreads == g_physical_cpus,
+            // and the one after that will be the last with gopt_nthreads_max.
+            nthreads = g_physical_cpus / 2;
+            exp_have_physical = true;
+        }
 
-            ERR("Running"
-                << " nthreads=" << g_nthreads
-                << " factor=" << factor
-                << " areasize=" << *areasize
-                << " thrsize=" << g_thrsize
-                << " testsize=" << testsize
-                << " repeats=" << g_repeats
-                << " testvol=" << testvol
-                << " testaccess=" << testaccess);
+        if (nthreads > gopt_nthreads_max)
+            nthreads = gopt_nthreads_max;
+    }
+}
 
-            g_done = false;
-            double runtime;
+// cpu list of the node currently tested in NUMA matrix mode
+std::string g_matrix_affinity;
 
-            // synchronize with worker threads and run a worker ourselves
-            {
-                // *** Barrier ****
-                pthread_barrier_wait(&g_barrier);
+// run a test function with threads pinned to the cpus of each NUMA node and
+// memory bound to each NUMA node, yielding results for all node pairs.
+void testfunc_numamatrix(const TestFunction* func)
+{
+    if (!match_funcfilter(func->name)) {
+        ERR("Skipping " << func->name << " tests");
+        return;
+    }
 
-                assert(!g_done);
+    int nthreads_min = gopt_nthreads_min, nthreads_max = gopt_nthreads_max;
 
-                // create cyclic permutation for each thread
-                if (g_func->make_permutation)
-                    make_cyclic_permutation(thread_num, g_memarea + thread_num * g_thrsize_spaced, g_thrsize);
+    for (size_t a = 0; a < g_numa_nodes.size(); ++a)
+    {
+        // collect the cpus of node a we are allowed to run on
+        std::ostringstream cpulist;
+        unsigned int ncpus = 0;
+        for (size_t i = 0; i < g_topology.size(); ++i)
+        {
+            if (cpu_node(g_topology[i].cpu) != g_numa_nodes[a]) continue;
+            cpulist << (ncpus++ ? "," : "") << g_topology[i].cpu;
+        }
 
-                // *** Barrier ****
-                pthread_barrier_wait(&g_barrier);
-                double ts1 = timestamp();
+        if (ncpus == 0) {
+            ERR("Skipping NUMA node " << g_numa_nodes[a] << " without usable cpus.");
+            continue;
+        }
 
-                g_func->func(g_memarea + thread_num * g_thrsize_spaced, g_thrsize, g_repeats);
+        g_matrix_affinity = cpulist.str();
+        if (!make_affinity_order(g_matrix_affinity.c_str())) continue;
+        gopt_affinity = g_matrix_affinity.c_str();
 
-                // *** Barrier ****
-                pthread_barrier_wait(&g_barrier);
-                double ts2 = timestamp();
+        // without explicit thread counts, measure latency with one thread and
+        // bandwidth with all cpus of the node.
+        if (nthreads_min == 0 && nthreads_max == 0)
+            gopt_nthreads_min = gopt_nthreads_max = (func->make_permutation ? 1 : ncpus);
 
-                runtime = ts2 - ts1;
-            }
+        for (size_t b = 0; b < g_numa_nodes.size(); ++b)
+        {
+            g_numa_mode = NUMA_BIND;
+            g_numa_bind_node = g_numa_nodes[b];
 
-            if ( runtime < g_min_time )
-            {
-                // test ran for less than one second, repeat test and scale
-                // repeat factor
-                factor = g_thrsize * g_repeats * g_avg_time / runtime;
-                ERR("run time = " << runtime << " -> rerunning test with repeat factor=" << factor);
+            ERR("Running " << func->name << " with threads on NUMA node " << g_numa_nodes[a]
+                << " and memory on NUMA node " << g_numa_nodes[b] << ".");
 
-                --round;     // redo this areasize
-            }
-            else
-            {
-                // adapt repeat factor to observed memory bandwidth, so that
-                // next test will take approximately g_avg_time sec
+            testfunc(func);
+        }
+
+        gopt_nthreads_min = nthreads_min, gopt_nthreads_max = nthreads_max;
+    }
+}
+
+// run a permutation test function in thread 0 while all other threads run the
+// load kernel, once for each delay between the load kernel's chunks, yielding
+// the access time under increasing memory load.
+void testfunc_loaded(const TestFunction* func)
+{
+    if (!match_funcfilter(func->name)) {
+        ERR("Skipping " << func->name << " tests");
+        return;
+    }
+    if (!func->make_permutation) {
+        ERR("Skipping " << func->name << " test, loaded latency mode measures permutation tests only.");
+        return;
+    }
+
+    int nthreads_min = gopt_nthreads_min, nthreads_max = gopt_nthreads_max;
+
+    // without explicit thread counts, load all cpus
+    if (nthreads_min == 0 && nthreads_max == 0)
+        gopt_nthreads_min = gopt_nthreads_max = std::max(2, g_physical_cpus);
+    else if (gopt_nthreads_min < 2)
+        gopt_nthreads_min = 2;
+
+    for (size_t d = 0; d < gopt_load_delays.size(); ++d)
+    {
+        g_load_delay = gopt_load_delays[d];
+
+        ERR("Running " << func->name << " with load " << g_loadfunc->name
+            << " and delay " << g_load_delay << ".");
+
+        testfunc(func);
+    }
+
+    gopt_nthreads_min = nthreads_min, gopt_nthreads_max = nthreads_max;
+}
+
+// number of barrier waits per thread in the barrier microbenchmark
+uint64_t g_barrier_iterations;
+
+// runtime of the barrier microbenchmark measured by thread 0
+double g_barrier_runtime;
+
+// thread of the barrier microbenchmark: wait in the barrier repeatedly
+void* thread_barrier_bench(void* cookie)
+{
+    // this weirdness is because (void*) cannot be cast to int and back.
+    int thread_num = *((int*)cookie);
+    delete (int*)cookie;
+
+    pin_thread(thread_num);
+
+    barrier_wait();
+    double ts1 = timestamp();
+
+    for (uint64_t i = 0; i < g_barrier_iterations; ++i)
+        barrier_wait();
+
+    if (thread_num == 0)
+        g_barrier_runtime = timestamp() - ts1;
+
+    g_threadinfo[thread_num].cpu = current_cpu();
+
+    return NULL;
+}
+
+// measure the cost of one barrier wait for increasing thread counts, which
+// can be subtracted from short tests, each test passes three barriers.
+void testbarrier()
+{
+    int nthreads = (gopt_nthreads_min != 0) ? gopt_nthreads_min : 1;
+    int nthreads_max = (gopt_nthreads_max != 0) ? gopt_nthreads_max : g_physical_cpus;
+
+    for ( ; nthreads <= nthreads_max;
+          nthreads = gopt_nthreads_exponential ? 2 * nthreads : nthreads + 1)
+    {
+        g_nthreads = nthreads;
+        g_barrier_iterations = 1024;
+
+        while (1)
+        {
+            barrier_init(nthreads);
+            g_threadinfo.assign(nthreads, ThreadInfo());
+
+            pthread_t thr[nthreads];
+            for (int p = 0; p < nthreads; ++p)
+                pthread_create(&thr[p], NULL, thread_barrier_bench, new int(p));
+
+            for (int p = 0; p < nthreads; ++p)
+                pthread_join(thr[p], NULL);
+
+            barrier_destroy();
+
+            if (g_barrier_runtime >= g_min_time) break;
+
+            // rerun with iterations scaled to take about g_avg_time
+            double scale = g_avg_time / std::max(g_barrier_runtime, 1e-3);
+            g_barrier_iterations = g_barrier_iterations * std::min(scale, 1000.0) + 1;
+            ERR("run time = " << g_barrier_runtime << " -> rerunning barrier test with iterations=" << g_barrier_iterations);
+        }
+
+        ResultRecord result;
+        result_add_header(result);
+
+        result.str("mode", gopt_mode)
+            .str("funcname", "Barrier")
+            .num("nthreads", nthreads)
+            .num("repeats", g_barrier_iterations)
+            .num("time", g_barrier_runtime)
+            .num("rate", g_barrier_runtime / g_barrier_iterations)
+            .str("barrier", gopt_barrier)
+            .str("affinity", gopt_affinity ? gopt_affinity : "none")
+            .list("cpus", threadinfo_cpus());
+
+        output_result(result);
+    }
+}
+
+static inline uint64_t round_up_power2(uint64_t v)
+{
+    v--;
+    v |= v >> 1;     v |= v >> 2;
+    v |= v >> 4;     v |= v >> 8;
+    v |= v >> 16;    v |= v >> 32;
+    v++;
+    return v + (v == 0);
+}
+
+// -----------------------------------------------------------------------------
+// --- Pointer Chasing Latency Probes
+
+// minimum runtime of one latency probe. The probed chains are short and stay
+// in one cache level, such that a much shorter time than g_min_time suffices.
+static const double g_probe_time = 0.05;
+
+// number of timed runs of each probe, of which the fastest is reported
+static const int g_probe_runs = 3;
+
+// keeps the end of a pointer chase alive
+void* volatile g_chase_sink;
+
+// link the addresses into one cycle visited in random order, starting at
+// addrs[0]. The order defeats the hardware prefetchers.
+static void link_chase(std::vector<char*>& addrs, uint64_t seed)
+{
+    LCGRandom srnd(seed);
+
+    for (size_t n = addrs.size() - 1; n > 1; --n)
+        std::swap(addrs[n], addrs[1 + random_below(srnd, n)]);
+
+    for (size_t i = 0; i < addrs.size(); ++i)
+        *(void**)addrs[i] = addrs[(i + 1) % addrs.size()];
+}
+
+// follow the pointer chain starting at cookie for steps (a multiple of 8)
+// accesses
+static void chase_run(void* cookie, uint64_t steps)
+{
+    void* p = cookie;
+    for (uint64_t i = 0; i < steps; i += 8)
+    {
+        p = *(void**)p; p = *(void**)p; p = *(void**)p; p = *(void**)p;
+        p = *(void**)p; p = *(void**)p; p = *(void**)p; p = *(void**)p;
+    }
+    g_chase_sink = p;
+}
+
+// measure the time of one access of a probe run, which performs steps (a
+// multiple of unit) dependent accesses: calibrate the number of steps to take
+// g_probe_time, and report the fastest of g_probe_runs runs.
+static double probe_latency(void (*run)(void* cookie, uint64_t steps), void* cookie,
+                            uint64_t unit, uint64_t& steps)
+{
+    steps = (1024 + unit - 1) / unit * unit;
+    run(cookie, steps); // warm up caches and TLBs
+
+    double runtime;
+    while (1)
+    {
+        double ts1 = timestamp();
+        run(cookie, steps);
+        runtime = timestamp() - ts1;
+
+        if (runtime >= g_probe_time) break;
+
+        double scale = 1.5 * g_probe_time / std::max(runtime, 1e-6);
+        steps = (uint64_t)(steps * std::min(scale, 1000.0) + unit - 1) / unit * unit;
+    }
+
+    for (int r = 1; r < g_probe_runs; ++r)
+    {
+        double ts1 = timestamp();
+        run(cookie, steps);
+        runtime = std::min(runtime, timestamp() - ts1);
+    }
+
+    return runtime / steps;
+}
+
+// run a probe in one thread pinned like thread 0 of the tests
+static void run_probe(void* (*probe)(void*))
+{
+    g_nthreads = 1;
+    g_threadinfo.assign(1, ThreadInfo());
+
+    pthread_t thr;
+    pthread_create(&thr, NULL, probe, NULL);
+    pthread_join(thr, NULL);
+}
+
+// strides of the associativity probe, from -k or the detected caches
+std::vector<uint64_t> g_assoc_strides;
+
+// largest number of conflicting addresses of the associativity probe
+size_t g_assoc_addresses = 32;
+
+// choose the strides and number of addresses of the associativity probe: a
+// page and the set span (size / ways) of each cache level rounded up to a
+// power of two, up to twice the largest associativity.
+static void select_assoc_strides()
+{
+    for (size_t i = 0; i < gopt_strides.size(); ++i)
+        g_assoc_strides.push_back(gopt_strides[i]);
+
+    if (g_assoc_strides.empty())
+    {
+        g_assoc_strides.push_back(4096);
+        for (size_t i = 0; i < g_caches.size(); ++i)
+        {
+            if (g_caches[i].ways == 0) continue;
+            g_assoc_strides.push_back(round_up_power2(g_caches[i].size / g_caches[i].ways));
+        }
+        std::sort(g_assoc_strides.begin(), g_assoc_strides.end());
+        g_assoc_strides.erase(std::unique(g_assoc_strides.begin(), g_assoc_strides.end()),
+                              g_assoc_strides.end());
+    }
+
+    for (size_t i = 0; i < g_caches.size(); ++i)
+        g_assoc_addresses = std::max<size_t>(g_assoc_addresses, 2 * g_caches[i].ways + 4);
+
+    // physical addresses keep the stride only within a page
+    if (g_assoc_strides.back() > g_pagesize) {
+        ERR("Strides above the page size of " << g_pagesize << " bytes may map to random sets of physically indexed caches"
+            << (gopt_hugepages ? "." : ", use -H thp, 2M or 1G to probe larger caches."));
+    }
+}
+
+// thread of the associativity probe: for each stride, chase N addresses spaced
+// by the stride for increasing N. Once N exceeds the associativity of a cache
+// whose set span divides the stride, the addresses thrash one set and the
+// access time jumps to that of the next level.
+void* thread_assoc(void*)
+{
+    pin_thread(0);
+    g_threadinfo[0].cpu = current_cpu();
+
+    for (size_t s = 0; s < g_assoc_strides.size(); ++s)
+    {
+        uint64_t stride = g_assoc_strides[s];
+        size_t nmax = std::min<uint64_t>(g_assoc_addresses, g_memsize / stride);
+
+        touch_memarea(nmax * stride);
+
+        size_t thpbytes;
+        size_t pagesize = backing_pagesize(nmax * stride, thpbytes);
+
+        for (size_t n = 1; n <= nmax; ++n)
+        {
+            std::vector<char*> addrs(n);
+            for (size_t i = 0; i < n; ++i)
+                addrs[i] = g_memarea + i * stride;
+
+            link_chase(addrs, 233349568 + n);
+
+            uint64_t steps;
+            double rate = probe_latency(chase_run, g_memarea, 8, steps);
+
+            ResultRecord result;
+            result_add_header(result);
+
+            result.str("mode", gopt_mode)
+                .str("funcname", "AssocRead64")
+                .num("nthreads", 1)
+                .num("areasize", n * stride)
+                .num("testaccess", steps)
+                .num("time", rate * steps)
+                .num("rate", rate)
+                .str("timer", gopt_timer)
+                .num("counterhz", g_cycle_hz)
+                .num("cycles_per_access", rate * g_cycle_hz)
+                .str("affinity", gopt_affinity ? gopt_affinity : "none")
+                .list("cpus", threadinfo_cpus())
+                .str("hugepages", gopt_hugepages ? gopt_hugepages : "none")
+                .num("pagesize", pagesize);
+
+            if (gopt_hugepages && strcmp(gopt_hugepages, "thp") == 0)
+                result.num("thpbytes", thpbytes);
+
+            result.num("stride", stride)
+                .num("addresses", n);
+
+            output_result(result);
+        }
+    }
+
+    return NULL;
+}
+
+// -----------------------------------------------------------------------------
+// --- TLB Reach Probe
+
+#if __linux__
+
+#ifndef MFD_HUGETLB
+#define MFD_HUGETLB 0x0004U
+#endif
+
+// page sizes of the TLB probe and their memfd_create flags
+struct TlbPageSize
+{
+    const char* name;
+    size_t size;
+    unsigned int shift, mfd_flags;
+};
+
+static const TlbPageSize g_tlb_pagesizes[] = {
+    { "none", 4096, 12, 0 },
+    { "2M", 2 * 1024 * 1024, 21, MFD_HUGETLB | (21U << 26) },
+    { "1G", 1024 * 1024 * 1024, 30, MFD_HUGETLB | (30U << 26) },
+};
+
+// n virtual pages all mapping the same physical page of a memfd
+struct TlbAliases
+{
+    char* area;                 // reserved address range
+    size_t length;
+    char* base;                 // first page aligned to the page size
+};
+
+// map one physical page of the given size at n consecutive virtual pages.
+// All pages hit the same cache lines, but each needs its own TLB entry.
+static bool map_tlb_aliases(const TlbPageSize& ps, size_t n, TlbAliases& ta)
+{
+#ifdef SYS_memfd_create
+    int fd = syscall(SYS_memfd_create, "pmbw-tlb", ps.mfd_flags);
+    if (fd < 0) return false;
+
+    if (ftruncate(fd, ps.size) != 0) {
+        close(fd);
+        return false;
+    }
+
+    // reserve the address range, with room to align it to the page size
+    ta.length = (n + 1) * ps.size;
+    ta.area = (char*)mmap(NULL, ta.length, PROT_NONE,
+                          MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (ta.area == MAP_FAILED) {
+        close(fd);
+        return false;
+    }
+    ta.base = (char*)(((uintptr_t)ta.area + ps.size - 1) & ~(uintptr_t)(ps.size - 1));
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        void* page = mmap(ta.base + i * ps.size, ps.size, PROT_READ | PROT_WRITE,
+                          MAP_SHARED | MAP_FIXED | MAP_POPULATE, fd, 0);
+        if (page == MAP_FAILED) {
+            munmap(ta.area, ta.length);
+            close(fd);
+            return false;
+        }
+    }
+
+    close(fd);
+    return true;
+#else
+    (void)ps, (void)n, (void)ta;
+    return false;
+#endif
+}
+
+// one TLB probe: the pages visited in order, each at the same offset
+struct TlbProbe
+{
+    const char* base;
+    std::vector<uint32_t> order;
+    unsigned int pageshift;
+};
+
+// visit the pages in order for steps (a multiple of the pages) accesses. Each
+// address depends on the previous load, which always reads zero.
+static void tlb_run(void* cookie, uint64_t steps)
+{
+    const TlbProbe& tp = *(const TlbProbe*)cookie;
+    const uint32_t* order = &tp.order[0];
+    size_t n = tp.order.size();
+
+    uint64_t x = 0;
+    for (uint64_t s = 0; s < steps; s += n)
+    {
+        for (size_t k = 0; k < n; ++k)
+            x = *(const uint64_t*)(tp.base + ((order[k] + x) << tp.pageshift));
+    }
+    g_chase_sink = (void*)x;
+}
+
+// thread of the TLB probe: for each page size, access one word in each of N
+// pages for increasing N. The pages alias one physical page, such that the
+// access time grows only with misses of the L1 dTLB, the STLB and the cost of
+// page walks, not of cache misses.
+void* thread_tlb(void*)
+{
+    pin_thread(0);
+    g_threadinfo[0].cpu = current_cpu();
+
+    // each alias is one mapping, stay well below the limit of the kernel
+    size_t maxmaps = std::max(read_file_int("/proc/sys/vm/max_map_count"), 1024) / 2;
+
+    for (size_t p = 0; p < sizeof(g_tlb_pagesizes) / sizeof(g_tlb_pagesizes[0]); ++p)
+    {
+        const TlbPageSize& ps = g_tlb_pagesizes[p];
+
+        // largest power of two number of pages, reaching at most 16 TiB
+        size_t nmax = 1;
+        while (2 * nmax <= maxmaps && (2 * nmax << ps.shift) <= ((uint64_t)1 << 44))
+            nmax *= 2;
+
+        TlbAliases ta;
+        if (!map_tlb_aliases(ps, nmax, ta)) {
+            ERR("Skipping TLB probe with " << ps.size / 1024 << " KiB pages: "
+                << "could not map " << nmax << " aliases of one page.");
+            continue;
+        }
+
+        ERR("Running TLB probe with " << ps.size / 1024 << " KiB pages.");
+
+        // four page counts per octave
+        std::vector<size_t> pages;
+        for (size_t i = 0; ; ++i)
+        {
+            size_t n = (size_t)(pow(2.0, i / 4.0) + 0.5);
+            if (n > nmax) break;
+            if (pages.empty() || pages.back() != n) pages.push_back(n);
+        }
+
+        for (size_t i = 0; i < pages.size(); ++i)
+        {
+            size_t n = pages[i];
+
+            TlbProbe tp;
+            tp.base = ta.base;
+            tp.pageshift = ps.shift;
+            tp.order.resize(n);
+            for (size_t k = 0; k < n; ++k)
+                tp.order[k] = k;
+
+            LCGRandom srnd(233349568 + n);
+            for (size_t k = n - 1; k > 0; --k)
+                std::swap(tp.order[k], tp.order[random_below(srnd, k + 1)]);
+
+            uint64_t steps;
+            double rate = probe_latency(tlb_run, &tp, n, steps);
+
+            ResultRecord result;
+            result_add_header(result);
+
+            result.str("mode", gopt_mode)
+                .str("funcname", "TlbRead64")
+                .num("nthreads", 1)
+                .num("areasize", n * ps.size)
+                .num("testsize", n * ps.size)
+                .num("testvol", steps * sizeof(uint64_t))
+                .num("testaccess", steps)
+                .num("time", rate * steps)
+                .num("bandwidth", sizeof(uint64_t) / rate)
+                .num("rate", rate)
+                .str("timer", gopt_timer)
+                .num("counterhz", g_cycle_hz)
+                .num("cycles_per_access", rate * g_cycle_hz)
+                .str("affinity", gopt_affinity ? gopt_affinity : "none")
+                .list("cpus", threadinfo_cpus())
+                .str("hugepages", ps.name)
+                .num("pagesize", ps.size)
+                .num("pages", n);
+
+            output_result(result);
+        }
+
+        munmap(ta.area, ta.length);
+    }
+
+    return NULL;
+}
+
+#else // !__linux__
+
+void* thread_tlb(void*)
+{
+    ERR("The TLB probe requires Linux to map aliases of one page.");
+    return NULL;
+}
 
-                factor = g_thrsize * g_repeats * g_avg_time / runtime;
-                ERR("run time = " << runtime << " -> next test with repeat factor=" << factor);
+#endif // __linux__
 
-                std::ostringstream result;
-                result << "RESULT\t";
+// -----------------------------------------------------------------------------
+// --- Core-to-Core Cache Line Ping-Pong
 
-                // output date, time and hostname to result line
-                char datetime[64];
-                time_t tnow = time(NULL);
+// state of one ping-pong between two pinned threads
+struct PingPong
+{
+    volatile uint64_t* line;    // the bounced cache line
+    bool atomic;                // compare-and-swap instead of load and store
+    int cpu[2];                 // cpus of the two threads
+    bool pinned[2];             // whether each thread could be pinned
+    uint64_t rounds;            // round trips of the next run
+    bool stop;
+    double runtime;             // fastest run, measured by thread 0
+};
 
-                strftime(datetime, sizeof(datetime), "%Y-%m-%d %H:%M:%S", localtime(&tnow));
-                result << "datetime=" << datetime << '\t'
-                       << "host=" << g_hostname << '\t'
-                       << "version=" << PACKAGE_VERSION << '\t'
-                       << "funcname=" << g_func->name << '\t'
-                       << "nthreads=" << g_nthreads << '\t'
-                       << "areasize=" << *areasize << '\t'
-                       << "threadsize=" << g_thrsize << '\t'
-                       << "testsize=" << testsize << '\t'
-                       << "repeats=" << g_repeats << '\t'
-                       << "testvol=" << testvol << '\t'
-                       << "testaccess=" << testaccess << '\t'
-                       << "time=" << std::setprecision(20) << runtime << '\t'
-                       << "bandwidth=" << testvol / runtime << '\t'
-                       << "rate=" << runtime / testaccess;
+PingPong g_pingpong;
 
-                std::cout << result.str() << std::endl;
+// bounce the line for the given round trips: thread t waits for the value
+// 2i+t and replaces it by 2i+t+1, such that each round trip moves the line to
+// the other cpu and back. The waits spin without pause, which would add its
+// own latency.
+static inline void pingpong_run(int thread_num, uint64_t rounds)
+{
+    volatile uint64_t* line = g_pingpong.line;
+    uint64_t v = thread_num;
 
-                std::ofstream resultfile(gopt_output_file, std::ios::app);
-                resultfile << result.str() << std::endl;
-            }
+    if (g_pingpong.atomic)
+    {
+        for (uint64_t i = 0; i < rounds; ++i, v += 2)
+        {
+            while (!__sync_bool_compare_and_swap(line, v, v + 1)) { }
+        }
+    }
+    else
+    {
+        for (uint64_t i = 0; i < rounds; ++i, v += 2)
+        {
+            while (*line != v) { }
+            *line = v + 1;
         }
     }
-
-    g_done = true;
-
-    // *** Barrier ****
-    pthread_barrier_wait(&g_barrier);
-
-    return NULL;
 }
 
-void* thread_worker(void* cookie)
+// thread of the ping-pong: thread 0 calibrates the round trips to take
+// g_probe_time, then keeps the fastest of g_probe_runs runs. Both threads stop
+// right away if either could not be pinned to its cpu.
+void* thread_pingpong(void* cookie)
 {
     // this weirdness is because (void*) cannot be cast to int and back.
     int thread_num = *((int*)cookie);
     delete (int*)cookie;
 
+    g_pingpong.pinned[thread_num] = pin_cpu(g_pingpong.cpu[thread_num]);
+    g_threadinfo[thread_num].cpu = current_cpu();
+
+    barrier_wait();
+
+    uint64_t rounds = 1024;
+    int runs = 0;
+
     while (1)
     {
-        // *** Barrier ****
-        pthread_barrier_wait(&g_barrier);
-
-        if (g_done) break;
+        if (thread_num == 0) {
+            *g_pingpong.line = 0;
+            g_pingpong.rounds = rounds;
+            g_pingpong.stop = (runs == g_probe_runs ||
+                               !g_pingpong.pinned[0] || !g_pingpong.pinned[1]);
+        }
 
-        // create cyclic permutation for each thread
-        if (g_func->make_permutation)
-            make_cyclic_permutation(thread_num, g_memarea + thread_num * g_thrsize_spaced, g_thrsize);
+        barrier_wait();
+        if (g_pingpong.stop) break;
 
-        // *** Barrier ****
-        pthread_barrier_wait(&g_barrier);
+        if (thread_num == 0)
+        {
+            double ts1 = timestamp();
+            pingpong_run(0, g_pingpong.rounds);
+            while (*g_pingpong.line != 2 * g_pingpong.rounds) { }
+            double runtime = timestamp() - ts1;
 
-        g_func->func(g_memarea + thread_num * g_thrsize_spaced, g_thrsize, g_repeats);
+            if (runs == 0 && runtime < g_probe_time)
+            {
+                double scale = 1.5 * g_probe_time / std::max(runtime, 1e-6);
+                rounds = rounds * std::min(scale, 1000.0) + 1;
+            }
+            else
+            {
+                g_pingpong.runtime = (runs == 0) ? runtime : std::min(g_pingpong.runtime, runtime);
+                ++runs;
+            }
+        }
+        else
+        {
+            pingpong_run(1, g_pingpong.rounds);
+        }
 
-        // *** Barrier ****
-        pthread_barrier_wait(&g_barrier);
+        barrier_wait();
     }
 
     return NULL;
 }
 
-void testfunc(const TestFunction* func)
+// measure the round trip latency of a cache line between each pair of cpus,
+// by plain stores and loads and by atomic compare-and-swap. The cpus are those
+// of the affinity policy, or all allowed cpus in topology order.
+void testpingpong()
 {
-    if (!match_funcfilter(func->name)) {
-        ERR("Skipping " << func->name << " tests");
-        return;
+    std::vector<int> cpus;
+    if (!g_cpu_order.empty()) {
+        for (size_t i = 0; i < g_cpu_order.size(); ++i) {
+            if (std::find(cpus.begin(), cpus.end(), g_cpu_order[i]) == cpus.end())
+                cpus.push_back(g_cpu_order[i]);
+        }
+    }
+    else {
+        for (size_t i = 0; i < g_topology.size(); ++i)
+            cpus.push_back(g_topology[i].cpu);
     }
 
-    int nthreads = 1;
-
-    if (gopt_nthreads_min != 0)
-        nthreads = gopt_nthreads_min;
-
-    if (gopt_nthreads_max == 0)
-        gopt_nthreads_max = g_physical_cpus + 2;
+    if (cpus.size() < 2) {
+        ERR("Ping-pong needs at least two cpus, found " << cpus.size() << ".");
+        return;
+    }
 
-    bool exp_have_physical = false;
+    // bounce a line of its own at the start of the memory area
+    g_pingpong.line = (volatile uint64_t*)(((uintptr_t)g_memarea + 63) & ~(uintptr_t)63);
 
-    while (1)
+    for (int atomic = 0; atomic < 2; ++atomic)
     {
-        // globally set test function and thread number
-        g_func = func;
-        g_nthreads = nthreads;
+        const char* funcname = atomic ? "PingPongAtomic" : "PingPongStore";
+        if (!match_funcfilter(funcname)) continue;
 
-        // create barrier and run threads
-        pthread_barrier_init(&g_barrier, NULL, nthreads);
+        ERR("Running " << funcname << " on " << cpus.size() << " cpus.");
 
-        pthread_t thr[nthreads];
-        pthread_create(&thr[0], NULL, thread_master, new int(0));
-        for (int p = 1; p < nthreads; ++p)
-            pthread_create(&thr[p], NULL, thread_worker, new int(p));
+        // round trip times of all pairs, printed as a matrix at the end
+        std::map< std::pair<int,int>, double > matrix;
 
-        for (int p = 0; p < nthreads; ++p)
-            pthread_join(thr[p], NULL);
+        for (size_t a = 0; a < cpus.size(); ++a)
+        {
+            for (size_t b = a + 1; b < cpus.size(); ++b)
+            {
+                g_nthreads = 2;
+                g_threadinfo.assign(2, ThreadInfo());
+                g_pingpong.atomic = atomic;
+                g_pingpong.cpu[0] = cpus[a], g_pingpong.cpu[1] = cpus[b];
 
-        pthread_barrier_destroy(&g_barrier);
+                barrier_init(2);
 
-        // increase thread count
-        if (nthreads >= gopt_nthreads_max) break;
+                pthread_t thr[2];
+                for (int p = 0; p < 2; ++p)
+                    pthread_create(&thr[p], NULL, thread_pingpong, new int(p));
 
-        if (gopt_nthreads_exponential)
-            nthreads = 2 * nthreads;
-        else
-            nthreads++;
+                for (int p = 0; p < 2; ++p)
+                    pthread_join(thr[p], NULL);
 
-        // Prevent the next check from running the tests with g_physical_cpus
-        // twice if that is a power of two
-        if (gopt_nthreads_exponential && nthreads == g_physical_cpus)
-            exp_have_physical = true;
+                barrier_destroy();
 
-        if (gopt_nthreads_exponential && nthreads > g_physical_cpus &&
-            !exp_have_physical) {
-            // Halve it because we want both with and without hyperthreading.
-            // The next iteration will then have nthreads == g_physical_cpus,
-            // and the one after that will be the last with gopt_nthreads_max.
-            nthreads = g_physical_cpus / 2;
-            exp_have_physical = true;
+                if (!g_pingpong.pinned[0] || !g_pingpong.pinned[1]) {
+                    ERR("Skipping " << funcname << " between cpus " << cpus[a] << " and " << cpus[b]
+                        << ", which could not be pinned.");
+                    continue;
+                }
+
+                double rate = g_pingpong.runtime / g_pingpong.rounds;
+                matrix[std::make_pair(cpus[a], cpus[b])] = rate;
+
+                ResultRecord result;
+                result_add_header(result);
+
+                result.str("mode", gopt_mode)
+                    .str("funcname", funcname)
+                    .num("nthreads", 2)
+                    .num("testaccess", g_pingpong.rounds)
+                    .num("time", g_pingpong.runtime)
+                    .num("rate", rate)
+                    .str("timer", gopt_timer)
+                    .num("counterhz", g_cycle_hz)
+                    .num("cycles_per_access", rate * g_cycle_hz)
+                    .str("barrier", gopt_barrier)
+                    .str("affinity", gopt_affinity ? gopt_affinity : "none")
+                    .list("cpus", threadinfo_cpus())
+                    .list("cpunodes", threadinfo_cpunodes());
+
+                output_result(result);
+            }
         }
 
-        if (nthreads > gopt_nthreads_max)
-            nthreads = gopt_nthreads_max;
+        // round trip matrix in ns, the upper triangle mirrored
+        ERRX(funcname << " round trip [ns]:" << std::endl << "cpu");
+        for (size_t b = 0; b < cpus.size(); ++b)
+            ERRX('\t' << cpus[b]);
+        ERR("");
+        for (size_t a = 0; a < cpus.size(); ++a)
+        {
+            ERRX(cpus[a]);
+            for (size_t b = 0; b < cpus.size(); ++b)
+            {
+                std::pair<int,int> key(cpus[std::min(a, b)], cpus[std::max(a, b)]);
+                ERRX('\t');
+                if (matrix.count(key)) ERRX(std::fixed << std::setprecision(1) << matrix[key] * 1e9);
+            }
+            ERR("");
+        }
+        std::cerr.unsetf(std::ios_base::floatfield);
     }
 }
 
-static inline uint64_t round_up_power2(uint64_t v)
-{
-    v--;
-    v |= v >> 1;     v |= v >> 2;
-    v |= v >> 4;     v |= v >> 8;
-    v |= v >> 16;    v |= v >> 32;
-    v++;
-    return v + (v == 0);
-}
-
 void print_usage(const char* prog)
 {
     ERR("Usage: " << prog << " [options]" << std::endl
         << "Options:" << std::endl
+        << "  -A             Sample array sizes densely around the detected cache sizes." << std::endl
+        << "  -a <policy>    Pin threads to cpus: compact, scatter, physical or a cpu list like 0,2,4-7." << std::endl
+        << "  -B <barrier>   Thread barrier: pthread (default) or spin (sense-reversing, for short tests)." << std::endl
+        << "  -C             Verify that permutations form a single cycle." << std::endl
+        << "  -e <error>     Stop trials early at this relative error of the mean runtime, e.g. 0.01." << std::endl
+        << "  -E             Capture hardware performance counters of each test via perf_event_open." << std::endl
+        << "  -F <format>    Format of the output file: txt (RESULT lines, default), jsonl or csv." << std::endl
         << "  -f <match>     Run only benchmarks containing this substring, can be used multile times. Try \"list\"." << std::endl
+        << "  -D <delays>    Delays of load threads in loaded mode, list like 0,100,1000 [loop iterations]." << std::endl
+        << "  -k <strides>   Strides of Skip tests, list like 8,64,4K [bytes, multiple of 8] (default 8 to 16384)," << std::endl
+        << "                 or of assoc mode (default a page and the set span of each cache)." << std::endl
+        << "                 Skip tests only run with -k or if selected by -f." << std::endl
+        << "  -L <func>      Kernel run by load threads in loaded mode (default ScanRead64PtrUnrollLoop)." << std::endl
+        << "  -l <size>      Buffer of each load thread in loaded mode [byte] (default 4x the last level cache" << std::endl
+        << "                 over all load threads, at least 16 MiB)." << std::endl
+        << "  -m <mode>      Benchmark mode: sweep (default), numamatrix (each cpu node and memory node pair)" << std::endl
+        << "                 loaded (latency of Perm tests while other threads run the -L kernel)" << std::endl
+        << "                 barrier (cost of one barrier wait)" << std::endl
+        << "                 assoc (access time of N addresses spaced by each -k stride)" << std::endl
+        << "                 tlb (access time of N pages aliasing one 4K, 2M or 1G page)" << std::endl
+        << "                 or pingpong (round trip of a cache line between each pair of cpus)." << std::endl
+        << "  -I <init>      Memory initialization: lazy (touch as tests need it, default), full or populate." << std::endl
+        << "  -H <pages>     Back memory with huge pages: thp (transparent), 2M or 1G (hugetlbfs)." << std::endl
         << "  -M <size>      Limit the maximum amount of memory allocated at startup [byte]." << std::endl
-        << "  -o <file>      Write the results to <file> instead of stats.txt." << std::endl
+        << "  -N <numa>      Place memory: local (first-touch by each thread), interleave, or a node number to bind to." << std::endl
+        << "  -o <file>      Write the results to <file> instead of stats.txt (stats.jsonl, stats.csv)." << std::endl
         << "  -p <nthrs>     Run benchmarks with at least this thread count." << std::endl
         << "  -P <nthrs>     Run benchmarks with at most this thread count (overrides detected processor count)." << std::endl
         << "  -Q             Run benchmarks with exponentially increasing thread count." << std::endl
+        << "  -T <timer>     Timer: clock (clock_gettime, default) or counter (calibrated TSC or arm64 generic timer)." << std::endl
+        << "  -t <trials>    Measure each test this many times and report statistics of all trials." << std::endl
         << "  -s <size>      Limit the _minimum_ test array size [byte]. Set to 0 for no limit." << std::endl
         << "  -S <size>      Limit the _maximum_ test array size [byte]. Set to 0 for no limit." << std::endl
         );
@@ -746,7 +3868,7 @@ int main(int argc, char* argv[])
 
     int opt;
 
-    while ( (opt = getopt(argc, argv, "hf:M:o:p:P:Qs:S:")) != -1 )
+    while ( (opt = getopt(argc, argv, "hAa:B:CD:e:EF:f:H:I:k:L:l:m:M:N:o:p:P:Qs:S:t:T:")) != -1 )
     {
         switch (opt) {
         default:
@@ -754,6 +3876,61 @@ int main(int argc, char* argv[])
             print_usage(argv[0]);
             return EXIT_FAILURE;
 
+        case 'A':
+            gopt_adaptive_sizes = true;
+            ERR("Sampling array sizes densely around cache boundaries.");
+            break;
+
+        case 'a':
+            gopt_affinity = optarg;
+            ERR("Pinning threads to cpus using affinity '" << gopt_affinity << "'.");
+            break;
+
+        case 'B':
+            if (strcmp(optarg, "pthread") != 0 && strcmp(optarg, "spin") != 0) {
+                ERR("Invalid parameter for -B <barrier>.");
+                exit(EXIT_FAILURE);
+            }
+            gopt_barrier = optarg;
+            ERR("Synchronizing threads using " << gopt_barrier << " barriers.");
+            break;
+
+        case 'C':
+            gopt_testcycle = true;
+            ERR("Verifying cyclic permutations.");
+            break;
+
+        case 'D':
+            if (!parse_intlist(optarg, gopt_load_delays)) {
+                ERR("Invalid parameter for -D <delays>.");
+                exit(EXIT_FAILURE);
+            }
+            break;
+
+        case 'e':
+            gopt_relerr = strtod(optarg, NULL);
+            if (gopt_relerr <= 0 || gopt_relerr >= 1) {
+                ERR("Invalid parameter for -e <relative error>.");
+                exit(EXIT_FAILURE);
+            }
+            ERR("Stopping trials at relative error " << gopt_relerr << ".");
+            break;
+
+        case 'E':
+            gopt_perf = true;
+            ERR("Capturing hardware performance counters.");
+            break;
+
+        case 'F':
+            if (strcmp(optarg, "txt") != 0 && strcmp(optarg, "jsonl") != 0 &&
+                strcmp(optarg, "csv") != 0) {
+                ERR("Invalid parameter for -F <format>.");
+                exit(EXIT_FAILURE);
+            }
+            gopt_format = optarg;
+            ERR("Writing results as " << gopt_format << ".");
+            break;
+
         case 'f':
             if (strcmp(optarg,"list") == 0)
             {
@@ -789,6 +3966,72 @@ int main(int argc, char* argv[])
             }
             break;
 
+        case 'H':
+            if (!parse_hugepages(optarg)) {
+                ERR("Invalid parameter for -H <huge pages>.");
+                exit(EXIT_FAILURE);
+            }
+            else {
+                ERR("Backing memory with huge pages '" << gopt_hugepages << "'.");
+            }
+            break;
+
+        case 'I':
+            if (strcmp(optarg, "lazy") != 0 && strcmp(optarg, "full") != 0 &&
+                strcmp(optarg, "populate") != 0) {
+                ERR("Invalid parameter for -I <init>.");
+                exit(EXIT_FAILURE);
+            }
+            gopt_meminit = optarg;
+            ERR("Initializing memory: " << gopt_meminit << ".");
+            break;
+
+        case 'k':
+            if (!parse_sizelist(optarg, gopt_strides)) {
+                ERR("Invalid parameter for -k <strides>.");
+                exit(EXIT_FAILURE);
+            }
+            for (size_t i = 0; i < gopt_strides.size(); ++i) {
+                if (gopt_strides[i] < 8 || gopt_strides[i] % 8 != 0) {
+                    ERR("Invalid stride " << gopt_strides[i] << " for -k <strides>, must be a multiple of 8.");
+                    exit(EXIT_FAILURE);
+                }
+            }
+            break;
+
+        case 'L':
+            gopt_loadfunc = optarg;
+            break;
+
+        case 'l':
+            if (!parse_uint64t(optarg, gopt_loadsize) || gopt_loadsize < 4096) {
+                ERR("Invalid parameter for -l <load size>.");
+                exit(EXIT_FAILURE);
+            }
+            break;
+
+        case 'm':
+            if (strcmp(optarg, "sweep") != 0 && strcmp(optarg, "numamatrix") != 0 &&
+                strcmp(optarg, "loaded") != 0 && strcmp(optarg, "barrier") != 0 &&
+                strcmp(optarg, "assoc") != 0 && strcmp(optarg, "tlb") != 0 &&
+                strcmp(optarg, "pingpong") != 0) {
+                ERR("Invalid parameter for -m <mode>.");
+                exit(EXIT_FAILURE);
+            }
+            gopt_mode = optarg;
+            ERR("Running benchmarks in " << gopt_mode << " mode.");
+            break;
+
+        case 'N':
+            if (!parse_numa_mode(optarg)) {
+                ERR("Invalid parameter for -N <numa placement>.");
+                exit(EXIT_FAILURE);
+            }
+            else {
+                ERR("Placing memory on NUMA nodes using mode '" << optarg << "'.");
+            }
+            break;
+
         case 'o':
             gopt_output_file = optarg;
             ERR("Writing results to " << gopt_output_file << ".");
@@ -832,6 +4075,26 @@ int main(int argc, char* argv[])
             }
             break;
 
+        case 'T':
+            if (strcmp(optarg, "clock") != 0 && strcmp(optarg, "counter") != 0) {
+                ERR("Invalid parameter for -T <timer>.");
+                exit(EXIT_FAILURE);
+            }
+            gopt_timer = optarg;
+            ERR("Measuring time using " << gopt_timer << " timer.");
+            break;
+
+        case 't': {
+            int trials;
+            if (!parse_int(optarg, trials) || trials < 1) {
+                ERR("Invalid parameter for -t <trials>.");
+                exit(EXIT_FAILURE);
+            }
+            gopt_trials = trials;
+            ERR("Running up to " << gopt_trials << " trials per test.");
+            break;
+        }
+
         case 'S':
             if (!parse_uint64t(optarg, gopt_sizelimit_max)) {
                 ERR("Invalid parameter for -S <maximum size limit>.");
@@ -854,9 +4117,40 @@ int main(int argc, char* argv[])
     GetComputerName(g_hostname, &hostnameSize);
 #endif
 
+    detect_system_info();
+
+    // default output file name by format
+    if (strcmp(gopt_output_file, "stats.txt") == 0) {
+        if (strcmp(gopt_format, "jsonl") == 0)
+            gopt_output_file = "stats.jsonl";
+        else if (strcmp(gopt_format, "csv") == 0)
+            gopt_output_file = "stats.csv";
+    }
+
     // *** run CPUID
     cpuid_detect();
 
+    // *** check hardware performance counters
+
+    if (gopt_perf)
+        perf_detect();
+
+    // *** calibrate cycle counter and select timer
+
+    calibrate_cycle_counter();
+
+    if (g_cycle_hz > 0)
+        ERR("Cycle counter runs at " << g_cycle_hz / 1e6 << " MHz.");
+
+    if (strcmp(gopt_timer, "counter") == 0)
+    {
+        if (g_cycle_hz <= 0) {
+            ERR("No constant rate cycle counter available for -T counter.");
+            return EXIT_FAILURE;
+        }
+        g_use_cycle_counter = true;
+    }
+
     // *** allocate memory for tests
 
 #if !ON_WINDOWS
@@ -881,6 +4175,45 @@ int main(int argc, char* argv[])
 
     ERR("Detected " << physical_mem / 1024/1024 << " MiB physical RAM and " << g_physical_cpus << " CPUs. " << std::endl);
 
+    // *** detect cpu topology and select thread affinity
+
+    detect_topology();
+    detect_numa();
+    detect_caches();
+
+    if (strcmp(gopt_mode, "numamatrix") == 0)
+    {
+        if (g_numa_mode != NUMA_NONE || gopt_affinity) {
+            ERR("NUMA matrix mode selects thread affinity and memory placement itself, -a and -N cannot be used.");
+            return EXIT_FAILURE;
+        }
+        // memory is bound to each node in turn
+        g_numa_mode = NUMA_BIND;
+    }
+
+    if (g_numa_mode != NUMA_NONE && g_numa_nodes.empty()) {
+        ERR("No NUMA nodes detected, cannot place memory.");
+        return EXIT_FAILURE;
+    }
+    if (g_numa_mode == NUMA_BIND &&
+        std::find(g_numa_nodes.begin(), g_numa_nodes.end(), g_numa_bind_node) == g_numa_nodes.end()) {
+        ERR("NUMA node " << g_numa_bind_node << " is not online.");
+        return EXIT_FAILURE;
+    }
+
+    if (gopt_affinity)
+    {
+        if (!make_affinity_order(gopt_affinity)) {
+            ERR("Invalid thread affinity policy or cpu list '" << gopt_affinity << "'.");
+            return EXIT_FAILURE;
+        }
+
+        std::ostringstream oss;
+        for (size_t i = 0; i < g_cpu_order.size(); ++i)
+            oss << (i ? "," : "") << g_cpu_order[i];
+        ERR("Thread to cpu mapping: " << oss.str());
+    }
+
     // limit allocated memory via command line
     if (gopt_memlimit && gopt_memlimit < physical_mem)
         physical_mem = gopt_memlimit;
@@ -893,45 +4226,145 @@ int main(int argc, char* argv[])
 
     ERR("Allocating " << g_memsize / 1024/1024 << " MiB for testing.");
 
+    // NUMA matrix and loaded latency mode test only the largest array fitting
+    // into half of the memory, unless a minimum size is given with -s.
+    if ((strcmp(gopt_mode, "numamatrix") == 0 || strcmp(gopt_mode, "loaded") == 0) &&
+        gopt_sizelimit_min == 0)
+    {
+        for (const uint64_t* areasize = areasize_list; *areasize; ++areasize)
+        {
+            if (*areasize > g_memsize / 2) break;
+            if (*areasize > gopt_sizelimit_max && gopt_sizelimit_max != 0) break;
+            gopt_sizelimit_min = *areasize;
+        }
+        gopt_sizelimit_max = gopt_sizelimit_min;
+        ERR("Running " << gopt_mode << " mode with array size " << gopt_sizelimit_min << ".");
+    }
+
     // allocate memory area
 
-#if HAVE_POSIX_MEMALIGN
+    if (strcmp(gopt_meminit, "populate") == 0 && g_numa_mode != NUMA_NONE) {
+        ERR("NUMA placement touches the memory by the threads using it, -I populate cannot be used.");
+        return EXIT_FAILURE;
+    }
 
-    if (posix_memalign((void**)&g_memarea, 32, g_memsize) != 0) {
-        ERR("Error allocating memory.");
+    if (!alloc_memarea())
         return -1;
+
+    // mmap(MAP_POPULATE) already faulted in the pages, but not with
+    // transparent huge pages, which are touched in full instead.
+    if (strcmp(gopt_meminit, "populate") == 0 && g_memarea_mmap)
+        g_memarea_touched = g_memsize;
+    else if (strcmp(gopt_meminit, "lazy") != 0)
+        touch_memarea(g_memsize);
+
+    // *** select load kernel of loaded latency mode
+
+    if (strcmp(gopt_mode, "loaded") == 0)
+    {
+        if (!gopt_loadfunc) gopt_loadfunc = "ScanRead64PtrUnrollLoop";
+
+        for (size_t i = 0; i < g_testlist.size(); ++i)
+        {
+            if (strcmp(g_testlist[i]->name, gopt_loadfunc) == 0)
+                g_loadfunc = g_testlist[i];
+        }
+
+        if (!g_loadfunc || g_loadfunc->make_permutation || g_loadfunc->streams != 1 ||
+            g_loadfunc->strided ||
+            !g_loadfunc->is_supported()) {
+            ERR("Invalid or unsupported load kernel '" << gopt_loadfunc << "' for -L.");
+            return EXIT_FAILURE;
+        }
+
+        if (gopt_load_delays.empty())
+        {
+            // default delay sweep: from no delay to mostly idle load threads
+            for (int d = 0; d <= 65536; d = (d ? 4 * d : 16))
+                gopt_load_delays.push_back(d);
+        }
     }
 
-#else
+    // *** select strides of strided tests
 
-    g_memarea = (char*)malloc(g_memsize);
+    if (strcmp(gopt_mode, "assoc") == 0)
+        select_assoc_strides();
 
-#endif
+    // the stride sweep multiplies the tests, it only runs if asked for by
+    // strides or a function filter
+    bool run_strided = !gopt_strides.empty() || !gopt_funcfilter.empty();
 
-    // fill memory with junk, but this allocates physical memory
-    memset(g_memarea, 1, g_memsize);
+    if (gopt_strides.empty())
+    {
+        // default stride sweep: from every 64-bit word to every fourth page
+        for (uint64_t s = 8; s <= 16384; s *= 2)
+            gopt_strides.push_back(s);
+    }
 
     // *** perform memory tests
 
-    unlink(gopt_output_file);
+    if (!open_resultfile()) {
+        ERR("Error opening output file " << gopt_output_file << ": " << strerror(errno));
+        return EXIT_FAILURE;
+    }
 
-    for (size_t i = 0; i < g_testlist.size(); ++i)
+    if (strcmp(gopt_mode, "barrier") == 0)
     {
-        TestFunction* tf = g_testlist[i];
-
-        if (!tf->is_supported())
+        testbarrier();
+    }
+    else if (strcmp(gopt_mode, "assoc") == 0)
+    {
+        run_probe(thread_assoc);
+    }
+    else if (strcmp(gopt_mode, "tlb") == 0)
+    {
+        run_probe(thread_tlb);
+    }
+    else if (strcmp(gopt_mode, "pingpong") == 0)
+    {
+        testpingpong();
+    }
+    else
+    {
+        for (size_t i = 0; i < g_testlist.size(); ++i)
         {
-            ERR("Skipping " << tf->name << " test "
-                << "due to missing CPU feature '" << tf->cpufeat << "'.");
-            continue;
-        }
+            TestFunction* tf = g_testlist[i];
+
+            if (!tf->is_supported())
+            {
+                ERR("Skipping " << tf->name << " test "
+                    << "due to missing CPU feature '" << tf->cpufeat << "'.");
+                continue;
+            }
 
-        testfunc(tf);
+            if (tf->strided && !run_strided)
+            {
+                ERR("Skipping " << tf->name << " test, "
+                    << "select strided tests with -k <strides> or -f.");
+                continue;
+            }
+
+            // strided tests are run with each stride
+            std::vector<uint64_t> strides(1, g_stride);
+            if (tf->strided) strides = gopt_strides;
+
+            for (size_t s = 0; s < strides.size(); ++s)
+            {
+                g_stride = strides[s];
+
+                if (strcmp(gopt_mode, "numamatrix") == 0)
+                    testfunc_numamatrix(tf);
+                else if (strcmp(gopt_mode, "loaded") == 0)
+                    testfunc_loaded(tf);
+                else
+                    testfunc(tf);
+            }
+        }
     }
 
     // cleanup
 
-    free(g_memarea);
+    free_memarea();
 
     for (size_t i = 0; i < g_testlist.size(); ++i)
         delete g_testlist[i];
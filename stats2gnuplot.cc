@@ -9,6 +9,13 @@
  *
  * "./stats2gnuplot stats.txt | gnuplot"
  *
+ * With -s it instead prints a table of the bandwidth plateaus (cache levels
+ * and main memory) and the knees between them for each test and thread count.
+ *
+ * With -c the results of several hosts, and of several files of one host, are
+ * compared in overlay and ratio plots, or with -s in a table of the plateau
+ * bandwidths relative to the first host.
+ *
  ******************************************************************************
  * Copyright (C) 2013 Timo Bingmann <tb@panthema.net>
  *
@@ -40,6 +47,10 @@
 #include <stdlib.h>
 #include <math.h>
 #include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 // *** Warnings Output Function
 
@@ -53,19 +64,28 @@ bool gopt_warnings = false;
 
 static const char* funclist[] =
 {
+    "ScanWrite512PtrSimpleLoop",
+    "ScanWrite512PtrUnrollLoop",
+    "ScanWrite512PtrNonTemporal",
+    "ScanRead512PtrSimpleLoop",
+    "ScanRead512PtrUnrollLoop",
+
     "ScanWrite256PtrSimpleLoop",
     "ScanWrite256PtrUnrollLoop",
+    "ScanWrite256PtrNonTemporal",
     "ScanRead256PtrSimpleLoop",
     "ScanRead256PtrUnrollLoop",
 
     "ScanWrite128PtrSimpleLoop",
     "ScanWrite128PtrUnrollLoop",
+    "ScanWrite128PtrNonTemporal",
     "ScanRead128PtrSimpleLoop",
     "ScanRead128PtrUnrollLoop",
     "cScanWrite128PtrSimpleLoop",
 
     "ScanWrite64PtrSimpleLoop",
     "ScanWrite64PtrUnrollLoop",
+    "ScanWrite64PtrNonTemporal",
     "ScanRead64PtrSimpleLoop",
     "ScanRead64PtrUnrollLoop",
     "ScanWrite64IndexSimpleLoop",
@@ -93,14 +113,39 @@ static const char* funclist[] =
     "ScanRead16PtrSimpleLoop",
     "ScanRead16PtrUnrollLoop",
 
+    "StreamCopy256PtrUnrollLoop",
+    "StreamScale256PtrUnrollLoop",
+    "StreamAdd256PtrUnrollLoop",
+    "StreamTriad256PtrUnrollLoop",
+    "StreamCopy128PtrUnrollLoop",
+    "StreamScale128PtrUnrollLoop",
+    "StreamAdd128PtrUnrollLoop",
+    "StreamTriad128PtrUnrollLoop",
+
     "PermRead64SimpleLoop",
     "PermRead64UnrollLoop",
+    "PermRead64Chain2Loop",
+    "PermRead64Chain4Loop",
+    "PermRead64Chain8Loop",
+    "PermRead64Chain16Loop",
+    "PermRead64Chain32Loop",
     "cPermRead64SimpleLoop",
 
     "PermRead32SimpleLoop",
     "PermRead32UnrollLoop",
     "cPermRead32SimpleLoop",
 
+    "SkipWrite64PtrSimpleLoop",
+    "SkipRead64PtrSimpleLoop",
+    "cSkipWrite64PtrSimpleLoop",
+    "cSkipRead64PtrSimpleLoop",
+
+    "Barrier",
+    "AssocRead64",
+    "TlbRead64",
+    "PingPongStore",
+    "PingPongAtomic",
+
     NULL
 };
 
@@ -110,13 +155,101 @@ std::vector<std::string> g_unknown_funclist;
 // ****************************************************************************
 // *** Functions to read RESULT key-value files into Result vector
 
+/// a string within the input buffer, used while parsing without copying
+struct StrView
+{
+    const char* ptr;
+    size_t size;
+
+    StrView() : ptr(NULL), size(0) { }
+    StrView(const char* p, size_t s) : ptr(p), size(s) { }
+
+    bool operator== (const char* s) const
+    {
+        return strlen(s) == size && memcmp(ptr, s, size) == 0;
+    }
+};
+
+/// pool of interned strings, which results point to instead of holding their
+/// own copies. Each parsing thread has its own pool, hence no locking.
+class StringPool
+{
+public:
+    StringPool() : m_table(1024, (const std::string*)NULL), m_count(0) { }
+
+    ~StringPool()
+    {
+        for (size_t i = 0; i < m_table.size(); ++i) delete m_table[i];
+    }
+
+    /// return the pooled copy of s, adding it if it is new
+    const std::string* intern(const StrView& s)
+    {
+        if (2 * (m_count + 1) > m_table.size()) grow();
+
+        size_t i = lookup(s.ptr, s.size);
+        if (!m_table[i]) {
+            m_table[i] = new std::string(s.ptr, s.size);
+            ++m_count;
+        }
+        return m_table[i];
+    }
+
+protected:
+    /// open addressing hash table with linear probing
+    std::vector<const std::string*> m_table;
+    size_t m_count;
+
+    static size_t hash(const char* p, size_t n)
+    {
+        // FNV-1a
+        size_t h = 2166136261u;
+        for (size_t i = 0; i < n; ++i) h = (h ^ (unsigned char)p[i]) * 16777619u;
+        return h;
+    }
+
+    size_t lookup(const char* p, size_t n) const
+    {
+        size_t mask = m_table.size() - 1;
+        for (size_t i = hash(p, n) & mask; ; i = (i + 1) & mask)
+        {
+            if (!m_table[i]) return i;
+            if (m_table[i]->size() == n && memcmp(m_table[i]->data(), p, n) == 0) return i;
+        }
+    }
+
+    void grow()
+    {
+        std::vector<const std::string*> old(2 * m_table.size(), (const std::string*)NULL);
+        m_table.swap(old);
+        for (size_t i = 0; i < old.size(); ++i) {
+            if (old[i]) m_table[lookup(old[i]->data(), old[i]->size())] = old[i];
+        }
+    }
+};
+
+/// global: string pools of all parsing threads, kept as results point into them
+std::vector<StringPool*> g_string_pools;
+
+/// global: empty string for unset string fields
+static const std::string g_empty_string;
+
+/// one RESULT line. Results are stored as rows of fixed size, not in
+/// per-field column arrays: all plot routines sort, filter and group whole
+/// results by several fields and keep pointers to them, which columns would
+/// turn into index permutations over every array. Strings are interned, so a
+/// row holds no heap allocations of its own.
 struct Result
 {
-    // *** contains the field read from each RESULT line
-    std::string datetime;
-    std::string host;
-    std::string funcname;
+    // *** contains the field read from each RESULT line, strings are interned
+    const std::string* host;
+    const std::string* mode;
+    const std::string* funcname;
+    const std::string* cachesizes;   // capacities of the cache levels
+    const std::string* cachesharing; // cpus sharing one cache of each level
     size_t nthreads;
+    size_t streams;
+    size_t chains;
     size_t areasize;
     size_t threadsize;
     size_t testsize;
@@ -126,17 +259,37 @@ struct Result
     double time;
     double bandwidth;
     double rate;
+    int cpunode;         // NUMA node of the first thread
+    int memnode;         // NUMA node memory was bound to, -1 if not bound
+    int cpu[2];          // cpus of the first two threads, -1 if unknown
+    const std::string* barrier;
+    const std::string* loadfunc;
+    size_t delay;
+    double loadbandwidth;
+    size_t stride;       // bytes between accesses of strided functions, else 0
+    double linebandwidth;
+    size_t addresses;    // number of conflicting addresses in assoc mode
+    size_t pagesize;
+    size_t pages;        // number of pages accessed in tlb mode
     size_t funcname_id;  // index of funcname in funclist (for nicer order)
+    size_t run;          // index of input file in g_run_names
+    size_t series;       // index of host and run in g_series_names
 
     Result()
-        : nthreads(0), areasize(0), threadsize(0), testsize(0), repeats(0),
+        : host(&g_empty_string), mode(&g_empty_string), funcname(&g_empty_string),
+          cachesizes(&g_empty_string), cachesharing(&g_empty_string),
+          nthreads(0), streams(1), chains(1), areasize(0), threadsize(0), testsize(0), repeats(0),
           testvol(0), testaccess(0),
-          time(0), bandwidth(0), rate(0)
+          time(0), bandwidth(0), rate(0), cpunode(-1), memnode(-1),
+          barrier(&g_empty_string), loadfunc(&g_empty_string),
+          delay(0), loadbandwidth(0), stride(0), linebandwidth(0),
+          addresses(0), pagesize(0), pages(0), funcname_id(0), run(0), series(0)
     {
+        cpu[0] = cpu[1] = -1;
     }
 
     /// parse a single RESULT key-value and save its information
-    bool process_line_keyvalue(const std::string& key, const std::string& value);
+    bool process_line_keyvalue(const StrView& key, const StrView& value, StringPool& pool);
 
     /// sort order of results is: (funcname_id,nthreads,testsize)
     bool operator< (const Result& b) const
@@ -160,24 +313,79 @@ std::string g_gnuplot_output;
 /// global: the sorted results array
 std::vector<Result> g_results;
 
+/// global: results of NUMA matrix mode, kept apart from the size sweeps
+std::vector<Result> g_matrix_results;
+
+/// global: results of loaded latency mode, kept apart from the size sweeps
+std::vector<Result> g_loaded_results;
+
+/// global: results of the barrier microbenchmark
+std::vector<Result> g_barrier_results;
+
+/// global: results of strided access functions, swept over stride and size
+std::vector<Result> g_stride_results;
+
+/// global: results of the associativity probe, swept over stride and addresses
+std::vector<Result> g_assoc_results;
+
+/// global: results of the TLB probe, swept over page size and pages
+std::vector<Result> g_tlb_results;
+
+/// global: results of the core-to-core ping-pong, one per pair of cpus
+std::vector<Result> g_pingpong_results;
+
+/// global: number of threads parsing input files
+size_t gopt_parse_threads = 1;
+
+/// global: names of the input files, each holding one run
+std::vector<std::string> g_run_names;
+
+/// global: names of the hosts and runs compared with -c
+std::vector<std::string> g_series_names;
+
+/// copy a value into a zero-terminated buffer for the strto* functions, as
+/// the input buffer is not terminated after each value
+static inline bool
+value_to_buffer(const StrView& value, char* buffer, size_t size)
+{
+    if (value.size == 0 || value.size >= size) return false;
+    memcpy(buffer, value.ptr, value.size);
+    buffer[value.size] = 0;
+    return true;
+}
+
 /// parse a number as size_t with error detection
 static inline bool
-parse_sizet(const std::string& value, size_t& out)
+parse_sizet(const StrView& value, size_t& out)
 {
-    char* endp;
-    out = strtoull(value.c_str(), &endp, 10);
+    char buffer[64], *endp;
+    if (!value_to_buffer(value, buffer, sizeof(buffer))) return false;
+    out = strtoull(buffer, &endp, 10);
     return (endp && *endp == 0);
 }
 
 /// parse a number as double with error detection
 static inline bool
-parse_double(const std::string& value, double& out)
+parse_double(const StrView& value, double& out)
 {
-    char* endp;
-    out = strtod(value.c_str(), &endp);
+    char buffer[64], *endp;
+    if (!value_to_buffer(value, buffer, sizeof(buffer))) return false;
+    out = strtod(buffer, &endp);
     return (endp && *endp == 0);
 }
 
+/// parse a number as long, the value may be followed by other characters
+static inline long
+parse_long_prefix(const StrView& value, bool& complete)
+{
+    char buffer[64], *endp;
+    complete = false;
+    if (!value_to_buffer(value, buffer, sizeof(buffer))) return 0;
+    long v = strtol(buffer, &endp, 10);
+    complete = (endp && *endp == 0);
+    return v;
+}
+
 /// parse a funcname into funcname_id with error detection
 static inline bool
 find_funcname(const std::string& funcname, size_t& funcname_id)
@@ -201,24 +409,63 @@ find_funcname(const std::string& funcname, size_t& funcname_id)
     return false;
 }
 
+/// keys written by pmbw describing the system and test, which are not used
+static const char* g_metadata_keys[] = {
+    "version", "cpumodel", "kernel", "compiler", "compileropts",
+    "timer", "counterhz", "cycles_per_access", "affinity",
+    "hugepages", "thpbytes", "memnodes",
+    "threadbandwidth", "skew", "barrierwait", "trials", "loadsize",
+    NULL
+};
+
+/// key prefixes of counters and statistics over trials, which are not used
+static const char* g_metadata_prefixes[] = {
+    "perf_", "bandwidth_", "rate_",
+    NULL
+};
+
+/// check if a key is known metadata, which is accepted and ignored
+static bool is_metadata_key(const StrView& key)
+{
+    for (size_t i = 0; g_metadata_keys[i]; ++i) {
+        if (key == g_metadata_keys[i]) return true;
+    }
+    for (size_t i = 0; g_metadata_prefixes[i]; ++i) {
+        size_t len = strlen(g_metadata_prefixes[i]);
+        if (key.size > len && strncmp(key.ptr, g_metadata_prefixes[i], len) == 0)
+            return true;
+    }
+    return false;
+}
+
 /// parse a single RESULT key-value and save its information
-bool Result::process_line_keyvalue(const std::string& key, const std::string& value)
+bool Result::process_line_keyvalue(const StrView& key, const StrView& value, StringPool& pool)
 {
     if (key == "datetime") {
-        datetime = value;
         return true;
     }
     else if (key == "host") {
-        host = value;
+        host = pool.intern(value);
+        return true;
+    }
+    else if (key == "mode") {
+        mode = pool.intern(value);
         return true;
     }
     else if (key == "funcname") {
-        funcname = value;
-        return find_funcname(funcname, funcname_id);
+        // funcname_id is assigned after parsing in input order
+        funcname = pool.intern(value);
+        return true;
     }
     else if (key == "nthreads") {
         return parse_sizet(value, nthreads);
     }
+    else if (key == "streams") {
+        return parse_sizet(value, streams);
+    }
+    else if (key == "chains") {
+        return parse_sizet(value, chains);
+    }
     else if (key == "areasize") {
         return parse_sizet(value, areasize);
     }
@@ -246,82 +493,292 @@ bool Result::process_line_keyvalue(const std::string& key, const std::string& va
     else if (key == "rate") {
         return parse_double(value, rate);
     }
+    else if (key == "numa") {
+        // a node number if memory was bound, otherwise the placement mode
+        bool complete;
+        long node = parse_long_prefix(value, complete);
+        if (complete) memnode = node;
+        return true;
+    }
+    else if (key == "cpus") {
+        // the cpus of the first two threads, the list may be long
+        bool complete;
+        const char* end = value.ptr + value.size;
+        const char* comma = (const char*)memchr(value.ptr, ',', value.size);
+        cpu[0] = parse_long_prefix(StrView(value.ptr, (comma ? comma : end) - value.ptr), complete);
+        if (comma) {
+            const char* next = (const char*)memchr(comma + 1, ',', end - comma - 1);
+            cpu[1] = parse_long_prefix(StrView(comma + 1, (next ? next : end) - comma - 1), complete);
+        }
+        return true;
+    }
+    else if (key == "cachesizes") {
+        cachesizes = pool.intern(value);
+        return true;
+    }
+    else if (key == "cachesharing") {
+        cachesharing = pool.intern(value);
+        return true;
+    }
+    else if (key == "cpunodes") {
+        // the node of the first thread
+        bool complete;
+        cpunode = parse_long_prefix(value, complete);
+        return true;
+    }
+    else if (key == "barrier") {
+        barrier = pool.intern(value);
+        return true;
+    }
+    else if (key == "loadfunc") {
+        loadfunc = pool.intern(value);
+        return true;
+    }
+    else if (key == "delay") {
+        return parse_sizet(value, delay);
+    }
+    else if (key == "loadbandwidth") {
+        return parse_double(value, loadbandwidth);
+    }
+    else if (key == "stride") {
+        return parse_sizet(value, stride);
+    }
+    else if (key == "linebandwidth") {
+        return parse_double(value, linebandwidth);
+    }
+    else if (key == "addresses") {
+        return parse_sizet(value, addresses);
+    }
+    else if (key == "pagesize") {
+        return parse_sizet(value, pagesize);
+    }
+    else if (key == "pages") {
+        return parse_sizet(value, pages);
+    }
     else {
-        return false;
+        return is_metadata_key(key);
     }
 }
 
 /// process a single line containing RESULT key-value pairs
-bool process_line(const std::string& line)
+bool process_line(const char* line, const char* end,
+                  std::vector<Result>& results, StringPool& pool)
 {
-    std::string::size_type splitpos = line.find('\t');
-    if (splitpos == std::string::npos) return false;
+    const char* tab = (const char*)memchr(line, '\t', end - line);
+    if (!tab || !(StrView(line, tab - line) == "RESULT")) return false;
 
-    if (line.substr(0,splitpos) != "RESULT") return false;
+    Result result;
 
-    struct Result result;
-
-    do
+    while (tab != end)
     {
-        std::string::size_type splitprev = splitpos+1;
-        splitpos = line.find('\t', splitprev);
+        const char* begin = tab + 1;
+        tab = (const char*)memchr(begin, '\t', end - begin);
+        if (!tab) tab = end;
 
-        std::string keyvalue = line.substr(splitprev, splitpos - splitprev);
+        StrView keyvalue(begin, tab - begin);
 
-        std::string::size_type equalpos = keyvalue.find('=');
-        if (equalpos != std::string::npos)
+        const char* equal = (const char*)memchr(begin, '=', tab - begin);
+        if (equal)
         {
-            if (!result.process_line_keyvalue( keyvalue.substr(0,equalpos),
-                                               keyvalue.substr(equalpos+1) ))
+            if (!result.process_line_keyvalue( StrView(begin, equal - begin),
+                                               StrView(equal + 1, tab - equal - 1),
+                                               pool ))
             {
-                WARN("Invalid key-value pair: " << keyvalue);
+                WARN("Invalid key-value pair: " << std::string(keyvalue.ptr, keyvalue.size));
             }
         }
         else
         {
-            WARN("Invalid key-value pair: " << keyvalue);
+            WARN("Invalid key-value pair: " << std::string(keyvalue.ptr, keyvalue.size));
         }
     }
-    while(splitpos != std::string::npos);
 
-    g_results.push_back(result);
+    results.push_back(result);
 
     return true;
 }
 
-/// read a stream of RESULT lines
-void process_stream(std::istream& in)
+/// a range of whole lines of the input parsed by one thread
+struct ParseChunk
+{
+    const char* begin;
+    const char* end;
+    std::vector<Result> results;
+    StringPool* pool;
+    size_t run;
+};
+
+/// parse all lines of a chunk
+void* process_chunk(void* cookie)
+{
+    ParseChunk& chunk = *(ParseChunk*)cookie;
+
+    // each line holds one result, count them to allocate once
+    size_t lines = 0;
+    for (const char* p = chunk.begin;
+         (p = (const char*)memchr(p, '\n', chunk.end - p)) != NULL; ++p)
+        ++lines;
+    chunk.results.reserve(lines + 1);
+
+    const char* line = chunk.begin;
+    while (line < chunk.end)
+    {
+        const char* eol = (const char*)memchr(line, '\n', chunk.end - line);
+        if (!eol) eol = chunk.end;
+
+        // allow DOS line endings
+        const char* end = (eol > line && eol[-1] == '\r') ? eol - 1 : eol;
+
+        if (process_line(line, end, chunk.results, *chunk.pool)) {
+            chunk.results.back().run = chunk.run;
+        }
+        else {
+            WARN("Non-RESULT line: " << std::string(line, end - line));
+        }
+        line = eol + 1;
+    }
+
+    return NULL;
+}
+
+/// parse a buffer of RESULT lines of one run, split into chunks at line
+/// boundaries for gopt_parse_threads threads, and append the results in input
+/// order
+void process_buffer(const char* data, size_t size, size_t run)
 {
-    std::string line;
+    size_t nthreads = std::max<size_t>(1, std::min(gopt_parse_threads, size / (1024*1024) + 1));
+    std::vector<ParseChunk> chunks(nthreads);
+
+    const char* begin = data, *end = data + size;
+    for (size_t i = 0; i < nthreads; ++i)
+    {
+        const char* cend = (i + 1 == nthreads) ? end : data + size / nthreads * (i + 1);
+        if (cend < begin) cend = begin;
+
+        // extend chunk to the end of the line
+        if (cend != end) {
+            const char* eol = (const char*)memchr(cend, '\n', end - cend);
+            cend = eol ? eol + 1 : end;
+        }
+
+        chunks[i].begin = begin;
+        chunks[i].end = cend;
+        chunks[i].pool = new StringPool;
+        chunks[i].run = run;
+        g_string_pools.push_back(chunks[i].pool);
+        begin = cend;
+    }
 
-    while (std::getline(in,line) )
+    if (nthreads == 1)
+        process_chunk(&chunks[0]);
+    else
     {
-        if (!process_line(line)) {
-            WARN("Non-RESULT line: " << line);
+        // chunks whose thread could not be started are parsed here
+        std::vector<pthread_t> threads(nthreads);
+        std::vector<bool> started(nthreads);
+        for (size_t i = 0; i < nthreads; ++i)
+        {
+            started[i] = (pthread_create(&threads[i], NULL, process_chunk, &chunks[i]) == 0);
+            if (!started[i]) process_chunk(&chunks[i]);
+        }
+        for (size_t i = 0; i < nthreads; ++i)
+        {
+            if (started[i]) pthread_join(threads[i], NULL);
         }
     }
+
+    if (nthreads == 1 && g_results.empty()) {
+        g_results.swap(chunks[0].results);
+        return;
+    }
+
+    size_t total = g_results.size();
+    for (size_t i = 0; i < nthreads; ++i)
+        total += chunks[i].results.size();
+    g_results.reserve(total);
+
+    for (size_t i = 0; i < nthreads; ++i)
+        g_results.insert(g_results.end(), chunks[i].results.begin(), chunks[i].results.end());
+}
+
+/// read a stream of RESULT lines
+void process_stream(std::istream& in, const std::string& name)
+{
+    std::ostringstream oss;
+    oss << in.rdbuf();
+    std::string data = oss.str();
+
+    g_run_names.push_back(name);
+    process_buffer(data.data(), data.size(), g_run_names.size() - 1);
 }
 
-/// open a file as a stream
+/// map a file into memory and parse it
 void process_file(const char* path)
 {
-    std::ifstream in(path);
-    if (!in.good()) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
         ERR("Error opening file " << path << ": " << strerror(errno));
         return;
     }
-    return process_stream(in);
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+        // not a regular file, e.g. a pipe: read as a stream
+        close(fd);
+        std::ifstream in(path);
+        return process_stream(in, path);
+    }
+
+    if (st.st_size == 0) {
+        close(fd);
+        return;
+    }
+
+    void* data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if (data == MAP_FAILED) {
+        ERR("Error mapping file " << path << ": " << strerror(errno));
+        return;
+    }
+
+    madvise(data, st.st_size, MADV_SEQUENTIAL);
+    g_run_names.push_back(path);
+    process_buffer((const char*)data, st.st_size, g_run_names.size() - 1);
+
+    munmap(data, st.st_size);
+}
+
+/// assign funcname_id of all results in input order, such that unknown
+/// funcnames are ordered by their first appearance
+void assign_funcname_ids()
+{
+    // results of one test are usually adjacent, remember the last one
+    std::string last;
+    size_t last_id = 0;
+    bool last_valid = false;
+
+    for (size_t i = 0; i < g_results.size(); ++i)
+    {
+        Result& r = g_results[i];
+        if (!last_valid || *r.funcname != last) {
+            find_funcname(*r.funcname, last_id);
+            last = *r.funcname;
+            last_valid = true;
+        }
+        r.funcname_id = last_id;
+    }
 }
 
 /// check for multiple hosts
 bool check_multiple_hosts()
 {
     std::set<std::string> hostnames;
-    g_hostname = g_results[0].host;
+    g_hostname = *g_results[0].host;
 
     for (size_t i = 0; i < g_results.size(); ++i)
     {
-        hostnames.insert( g_results[i].host );
+        hostnames.insert( *g_results[i].host );
     }
 
     if (hostnames.size() > 1)
@@ -386,19 +843,19 @@ void plot_funcname_iteration(std::ostream& os, filter_type filter, data_print_fu
         const Result& r = g_results[i];
         if (!filter(r)) continue;
 
-        if (cfuncname == r.funcname && ctestsize == r.testsize)
+        if (cfuncname == *r.funcname && ctestsize == r.testsize)
         {
             WARN("Multiple results found for " << cfuncname
                  << " testsize " << ctestsize << ", ignoring second.");
             continue;
         }
 
-        if (cfuncname != r.funcname) // start new plot line
+        if (cfuncname != *r.funcname) // start new plot line
         {
             if (datass.str().size()) datass << "e" << std::endl;
 
-            plotlines.push_back("'-' using 1:2 title '" + r.funcname + "' with linespoints");
-            cfuncname = r.funcname;
+            plotlines.push_back("'-' using 1:2 title '" + *r.funcname + "' with linespoints");
+            cfuncname = *r.funcname;
         }
 
         print_func(datass, r);
@@ -432,11 +889,11 @@ bool filter_sequential(const Result& r) {
 }
 
 bool filter_sequential_nonpermutation(const Result& r) {
-    return (r.nthreads == 1) && (r.funcname.find("Perm") == std::string::npos);
+    return (r.nthreads == 1) && (r.funcname->find("Perm") == std::string::npos);
 }
 
 bool filter_sequential_64bit_reads(const Result& r) {
-    return (r.nthreads == 1) && (r.funcname.find("Read64") == std::string::npos);
+    return (r.nthreads == 1) && (r.funcname->find("Read64") == std::string::npos);
 }
 
 /// Plots showing just sequential memory bandwidth and latency
@@ -464,6 +921,151 @@ void plot_sequential(std::ostream& os)
     plot_funcname_iteration(os, filter_sequential_64bit_reads, plot_data_bandwidth);
 }
 
+/// Plot procedure: access time or cache line bandwidth of one thread walking
+/// several permutation cycles at once, over the number of cycles, with one
+/// plotline for every third power of two array size (2^12, 2^15, ...).
+void plot_chains_iteration(std::ostream& os, bool bandwidth)
+{
+    // map areasize -> chains -> access time
+    std::map< size_t, std::map<size_t,double> > chainrate;
+
+    for (size_t i = 0; i < g_results.size(); ++i)
+    {
+        const Result& r = g_results[i];
+        if (r.nthreads != 1) continue;
+        if (r.funcname->compare(0, 10, "PermRead64") != 0) continue;
+        if (r.chains == 1 && *r.funcname != "PermRead64UnrollLoop") continue;
+
+        // only array sizes 2^15, 2^18, 2^21, ...
+        size_t log2size = 0;
+        while (((size_t)1 << log2size) < r.areasize) ++log2size;
+        if (((size_t)1 << log2size) != r.areasize || log2size % 3 != 0) continue;
+
+        chainrate[r.areasize][r.chains] = r.rate;
+    }
+
+    std::ostringstream datass;
+    std::vector<std::string> plotlines;
+
+    for (std::map< size_t, std::map<size_t,double> >::const_iterator
+             ai = chainrate.begin(); ai != chainrate.end(); ++ai)
+    {
+        plotlines.push_back("'-' using 1:2 title 'log_2 size=" + toStr(log(ai->first) / log(2)) + "' with linespoints");
+
+        for (std::map<size_t,double>::const_iterator
+                 ci = ai->second.begin(); ci != ai->second.end(); ++ci)
+        {
+            datass << std::setprecision(20) << ci->first << "\t";
+            // each access of a large area misses a full 64 byte cache line
+            if (bandwidth)
+                datass << 64 / ci->second / 1024/1024/1024 << "\n";
+            else
+                datass << ci->second * 1e9 << "\n";
+        }
+        datass << "e\n";
+    }
+
+    join_plotlines(os, plotlines, datass);
+}
+
+/// Plots showing memory-level parallelism of one thread walking several
+/// independent permutation cycles
+void plot_chains(std::ostream& os)
+{
+    P("set xlabel 'Independent Permutation Cycles [1]'");
+    P("set logscale x 2");
+    P("set xtics auto");
+
+    P("set key top right");
+    P("set title '" << g_hostname << " - One Thread Memory-Level Parallelism (Access Time)'");
+    P("set ylabel 'Access Time [ns]'");
+    plot_chains_iteration(os, false);
+
+    P("set key top left");
+    P("set title '" << g_hostname << " - One Thread Memory-Level Parallelism (Cache Line Bandwidth)'");
+    P("set ylabel 'Bandwidth [GiB/s]'");
+    plot_chains_iteration(os, true);
+
+    P("unset logscale x");
+    P("set xtics 1");
+    P("set xlabel 'Array Size log_2 [B]'");
+}
+
+/// Plot procedure: bandwidth or cache line bandwidth of one strided function
+/// over the stride, with one plotline for every third power of two array size
+/// (2^15, 2^18, ...).
+void plot_strides_iteration(std::ostream& os, const std::string& funcname, bool linebandwidth)
+{
+    // map areasize -> stride -> bandwidth
+    std::map< size_t, std::map<size_t,double> > stridebw;
+
+    for (size_t i = 0; i < g_stride_results.size(); ++i)
+    {
+        const Result& r = g_stride_results[i];
+        if (r.nthreads != 1 || *r.funcname != funcname) continue;
+
+        // only array sizes 2^15, 2^18, 2^21, ...
+        size_t log2size = 0;
+        while (((size_t)1 << log2size) < r.areasize) ++log2size;
+        if (((size_t)1 << log2size) != r.areasize || log2size % 3 != 0) continue;
+
+        stridebw[r.areasize][r.stride] = linebandwidth ? r.linebandwidth : r.bandwidth;
+    }
+
+    std::ostringstream datass;
+    std::vector<std::string> plotlines;
+
+    for (std::map< size_t, std::map<size_t,double> >::const_iterator
+             ai = stridebw.begin(); ai != stridebw.end(); ++ai)
+    {
+        plotlines.push_back("'-' using 1:2 title 'log_2 size=" + toStr(log(ai->first) / log(2)) + "' with linespoints");
+
+        for (std::map<size_t,double>::const_iterator
+                 si = ai->second.begin(); si != ai->second.end(); ++si)
+        {
+            datass << std::setprecision(20) << si->first << "\t"
+                   << si->second / 1024/1024/1024 << "\n";
+        }
+        datass << "e\n";
+    }
+
+    join_plotlines(os, plotlines, datass);
+}
+
+/// Plots showing the bandwidth of one thread accessing a single word every
+/// stride bytes, for each strided function
+void plot_strides(std::ostream& os)
+{
+    if (g_stride_results.empty()) return;
+
+    P("set xlabel 'Stride [B]'");
+    P("set logscale x 2");
+    P("set xtics auto");
+    P("set yrange [0:*]");
+
+    std::set<std::string> done;
+    for (size_t i = 0; i < g_stride_results.size(); ++i)
+    {
+        const std::string& funcname = *g_stride_results[i].funcname;
+        if (!done.insert(funcname).second) continue;
+
+        P("set key top right");
+        P("set title '" << g_hostname << " - One Thread Strided Access - " << funcname << " (Bandwidth)'");
+        P("set ylabel 'Bandwidth [GiB/s]'");
+        plot_strides_iteration(os, funcname, false);
+
+        P("set key top right");
+        P("set title '" << g_hostname << " - One Thread Strided Access - " << funcname << " (Cache Line Bandwidth)'");
+        P("set ylabel 'Bandwidth [GiB/s]'");
+        plot_strides_iteration(os, funcname, true);
+    }
+
+    P("unset logscale x");
+    P("set yrange [*:*]");
+    P("set xtics 1");
+    P("set xlabel 'Array Size log_2 [B]'");
+}
+
 /// Plot procedure: iterate over results, filter them to show only one funcname
 /// and output a plot containing plotlines for each nthreads
 void plot_parallel_iteration(std::ostream& os, const std::string& funcname, data_print_func print_func)
@@ -477,7 +1079,7 @@ void plot_parallel_iteration(std::ostream& os, const std::string& funcname, data
     for (size_t i = 0; i < g_results.size(); ++i)
     {
         const Result& r = g_results[i];
-        if (r.funcname != funcname) continue;
+        if (*r.funcname != funcname) continue;
 
         if (cnthreads == r.nthreads && ctestsize == r.testsize)
         {
@@ -522,7 +1124,7 @@ void plot_parallel_speedup_bandwidth(std::ostream& os, const std::string& funcna
     for (size_t i = 0; i < g_results.size(); ++i)
     {
         const Result& r = g_results[i];
-        if (r.funcname != funcname) continue;
+        if (*r.funcname != funcname) continue;
 
         if (cnthreads == r.nthreads && ctestsize == r.testsize)
         {
@@ -610,50 +1212,1187 @@ void plot_parallel(std::ostream& os)
     }
 }
 
-void output_gnuplot(std::ostream& os)
+/// Plot a heatmap of node pairs for one funcname of the NUMA matrix results
+void plot_numamatrix_funcname(std::ostream& os, const std::string& funcname)
 {
-    P("set terminal pdf size 28cm,19.6cm linewidth 2.0 font \"Arial,18\" enhanced");
-    P("set output '" << g_gnuplot_output << "'");
-    P("");
-    P("set pointsize 0.7");
-    P("set style line 6 lc rgb '#f0b000'");
-    P("set style line 15 lc rgb '#f0b000'");
-    P("set style line 24 lc rgb '#f0b000'");
-    P("set style line 33 lc rgb '#f0b000'");
-    P("set style line 42 lc rgb '#f0b000'");
-    P("set style line 51 lc rgb '#f0b000'");
-    P("set style line 60 lc rgb '#f0b000'");
-    P("set style increment user");
-    P("");
-    P("set grid xtics ytics");
-    P("set xtics 1");
-    P("set xlabel 'Array Size log_2 [B]'");
-    P("set label 1 'pmbw " VERSION "' right at screen 0.98, screen 0.02");
+    // value of each (cpu node, memory node) pair
+    std::map< std::pair<int,int>, double > matrix;
+    int maxnode = 0;
 
-    plot_sequential(os);
-    plot_parallel(os);
-}
+    for (size_t i = 0; i < g_matrix_results.size(); ++i)
+    {
+        const Result& r = g_matrix_results[i];
+        if (*r.funcname != funcname) continue;
+        if (r.cpunode < 0 || r.memnode < 0) continue;
 
-/// main: read stdin or from all files on the command line
-int main(int argc, char* argv[])
-{
-    std::string opt_hostname_override;
-    std::string opt_gnuplot_output_override;
+        // show latency of permutation walks and bandwidth of all others
+        matrix[std::make_pair(r.cpunode, r.memnode)] =
+            (funcname.find("Perm") != std::string::npos)
+            ? r.rate * 1e9 : r.bandwidth / 1024/1024/1024;
 
-    if (argc == 1) {
-        process_stream(std::cin);
+        maxnode = std::max(maxnode, std::max(r.cpunode, r.memnode));
     }
-    else
-    {
-        // *** parse command line options
-        int opt;
+    if (matrix.empty()) return;
 
-        while ( (opt = getopt(argc, argv, "vh:o:")) != -1 )
+    // the image needs all cells, pairs of nodes without cpus or memory are NaN
+    std::ostringstream datass;
+    int label = 2;
+    for (int c = 0; c <= maxnode; ++c)
+    {
+        for (int m = 0; m <= maxnode; ++m)
         {
-            switch (opt) {
-            case 'h':
-                opt_hostname_override = optarg;
-                ERR("Setting hostname override to '" << opt_hostname_override << "'");
+            std::map< std::pair<int,int>, double >::const_iterator
+                mi = matrix.find(std::make_pair(c, m));
+
+            datass << c << "\t" << m << "\t";
+            if (mi == matrix.end()) {
+                datass << "NaN\n";
+                continue;
+            }
+            datass << std::setprecision(20) << mi->second << "\n";
+
+            std::ostringstream value;
+            value << std::fixed << std::setprecision(1) << mi->second;
+            P("set label " << label++ << " '" << value.str()
+              << "' at " << c << "," << m << " center front");
+        }
+    }
+
+    P("set title '" << g_hostname << " - NUMA Matrix "
+      << (funcname.find("Perm") != std::string::npos ? "Access Time [ns]" : "Bandwidth [GiB/s]")
+      << " - " << funcname << "'");
+    P("set xrange [-0.5:" << maxnode + 0.5 << "]");
+    P("set yrange [-0.5:" << maxnode + 0.5 << "]");
+    P("plot '-' using 1:2:3 with image notitle");
+    os << datass.str() << "e" << std::endl;
+
+    for (int l = 2; l < label; ++l)
+        P("unset label " << l);
+}
+
+/// Heatmaps of NUMA matrix results: one per funcname
+void plot_numamatrix(std::ostream& os)
+{
+    if (g_matrix_results.size() == 0) return;
+
+    P("set xlabel 'CPU NUMA Node'");
+    P("set ylabel 'Memory NUMA Node'");
+    P("set grid noxtics noytics");
+    P("set palette rgbformulae 22,13,-31");
+
+    std::set<std::string> funcnames;
+    for (size_t i = 0; i < g_matrix_results.size(); ++i)
+    {
+        if (funcnames.insert(*g_matrix_results[i].funcname).second)
+            plot_numamatrix_funcname(os, *g_matrix_results[i].funcname);
+    }
+
+    P("set xrange [*:*]");
+    P("set yrange [*:*]");
+    P("set grid xtics ytics");
+    P("set xlabel 'Array Size log_2 [B]'");
+}
+
+/// Loaded latency: access time of the permutation walk over the bandwidth of
+/// the load threads, one plotline per funcname, load kernel and array size
+void plot_loaded(std::ostream& os)
+{
+    if (g_loaded_results.size() == 0) return;
+
+    // map plotline title -> load bandwidth -> access time
+    std::map< std::string, std::map<double,double> > curves;
+
+    for (size_t i = 0; i < g_loaded_results.size(); ++i)
+    {
+        const Result& r = g_loaded_results[i];
+
+        std::string title = *r.funcname + " / " + *r.loadfunc
+            + " p=" + toStr(r.nthreads) + " size=" + toStr(r.testsize / 1024) + " KiB";
+
+        curves[title][r.loadbandwidth / 1024/1024/1024] = r.rate * 1e9;
+    }
+
+    std::ostringstream datass;
+    std::vector<std::string> plotlines;
+
+    for (std::map< std::string, std::map<double,double> >::const_iterator
+             ci = curves.begin(); ci != curves.end(); ++ci)
+    {
+        plotlines.push_back("'-' using 1:2 title '" + ci->first + "' with linespoints");
+
+        for (std::map<double,double>::const_iterator
+                 pi = ci->second.begin(); pi != ci->second.end(); ++pi)
+        {
+            datass << std::setprecision(20) << pi->first << "\t" << pi->second << "\n";
+        }
+        datass << "e\n";
+    }
+
+    P("set key top left");
+    P("set title '" << g_hostname << " - Loaded Memory Latency'");
+    P("set xlabel 'Bandwidth of Load Threads [GiB/s]'");
+    P("set ylabel 'Access Time [ns]'");
+    P("set xtics auto");
+    P("set yrange [0:*]");
+    join_plotlines(os, plotlines, datass);
+
+    P("set yrange [*:*]");
+    P("set xtics 1");
+    P("set xlabel 'Array Size log_2 [B]'");
+}
+
+/// Associativity probe: access time of N addresses spaced by a power of two
+/// over N, one plotline per stride. Each jump marks a cache level whose
+/// associativity was exceeded.
+void plot_assoc(std::ostream& os)
+{
+    if (g_assoc_results.size() == 0) return;
+
+    // map stride -> addresses -> access time
+    std::map< size_t, std::map<size_t,double> > curves;
+
+    for (size_t i = 0; i < g_assoc_results.size(); ++i)
+    {
+        const Result& r = g_assoc_results[i];
+        curves[r.stride][r.addresses] = r.rate;
+    }
+
+    std::ostringstream datass;
+    std::vector<std::string> plotlines;
+
+    for (std::map< size_t, std::map<size_t,double> >::const_iterator
+             ci = curves.begin(); ci != curves.end(); ++ci)
+    {
+        plotlines.push_back("'-' using 1:2 title 'stride=" + toStr(ci->first / 1024) + " KiB' with linespoints");
+
+        for (std::map<size_t,double>::const_iterator
+                 pi = ci->second.begin(); pi != ci->second.end(); ++pi)
+        {
+            datass << pi->first << "\t" << std::setprecision(20) << pi->second * 1e9 << "\n";
+        }
+        datass << "e\n";
+    }
+
+    P("set key top left");
+    P("set title '" << g_hostname << " - Cache Set Conflicts (Associativity)'");
+    P("set xlabel 'Addresses in one Cache Set [1]'");
+    P("set xtics auto");
+    P("set ylabel 'Access Time [ns]'");
+    P("set yrange [0:*]");
+    join_plotlines(os, plotlines, datass);
+
+    P("set yrange [*:*]");
+    P("set xtics 1");
+    P("set xlabel 'Array Size log_2 [B]'");
+}
+
+/// short name of a page size: 4K, 2M, 1G
+static std::string pagesize_label(size_t pagesize)
+{
+    if (pagesize >= 1024*1024*1024) return toStr(pagesize / 1024/1024/1024) + "G";
+    if (pagesize >= 1024*1024) return toStr(pagesize / 1024/1024) + "M";
+    return toStr(pagesize / 1024) + "K";
+}
+
+/// Plot procedure: access time of the TLB probe over the number of pages or
+/// the reach (pages times page size), one plotline per page size.
+void plot_tlb_iteration(std::ostream& os, bool reach)
+{
+    // map pagesize -> pages -> access time
+    std::map< size_t, std::map<size_t,double> > curves;
+
+    for (size_t i = 0; i < g_tlb_results.size(); ++i)
+    {
+        const Result& r = g_tlb_results[i];
+        curves[r.pagesize][r.pages] = r.rate;
+    }
+
+    std::ostringstream datass;
+    std::vector<std::string> plotlines;
+
+    for (std::map< size_t, std::map<size_t,double> >::const_iterator
+             ci = curves.begin(); ci != curves.end(); ++ci)
+    {
+        plotlines.push_back("'-' using 1:2 title '" + pagesize_label(ci->first) + " pages' with linespoints");
+
+        for (std::map<size_t,double>::const_iterator
+                 pi = ci->second.begin(); pi != ci->second.end(); ++pi)
+        {
+            double x = reach ? (double)pi->first * ci->first : (double)pi->first;
+            datass << std::setprecision(20) << log(x) / log(2) << "\t"
+                   << pi->second * 1e9 << "\n";
+        }
+        datass << "e\n";
+    }
+
+    join_plotlines(os, plotlines, datass);
+}
+
+/// TLB probe: access time of one word in each of N pages aliasing one
+/// physical page, which shows the L1 dTLB, STLB and page walk levels.
+void plot_tlb(std::ostream& os)
+{
+    if (g_tlb_results.size() == 0) return;
+
+    P("set key top left");
+    P("set ylabel 'Access Time [ns]'");
+    P("set yrange [0:*]");
+
+    P("set title '" << g_hostname << " - TLB Reach and Page Walk Latency (Pages)'");
+    P("set xlabel 'Pages log_2 [1]'");
+    plot_tlb_iteration(os, false);
+
+    P("set title '" << g_hostname << " - TLB Reach and Page Walk Latency (Reach)'");
+    P("set xlabel 'Reach of Pages log_2 [B]'");
+    plot_tlb_iteration(os, true);
+
+    P("set yrange [*:*]");
+    P("set xlabel 'Array Size log_2 [B]'");
+}
+
+/// Heatmap of the ping-pong round trip time of one funcname between each pair
+/// of cpus, the matrix is symmetric.
+void plot_pingpong_funcname(std::ostream& os, const std::string& funcname)
+{
+    // map (cpu,cpu) -> round trip time, and the cpus on the axes
+    std::map< std::pair<int,int>, double > matrix;
+    std::set<int> cpus;
+
+    for (size_t i = 0; i < g_pingpong_results.size(); ++i)
+    {
+        const Result& r = g_pingpong_results[i];
+        if (*r.funcname != funcname) continue;
+        if (r.cpu[0] < 0 || r.cpu[1] < 0) continue;
+
+        matrix[std::make_pair(r.cpu[0], r.cpu[1])] = r.rate * 1e9;
+        matrix[std::make_pair(r.cpu[1], r.cpu[0])] = r.rate * 1e9;
+        cpus.insert(r.cpu[0]), cpus.insert(r.cpu[1]);
+    }
+    if (matrix.empty()) return;
+
+    // number the cpus on the axes, which need not be contiguous
+    std::map<int,int> axis;
+    for (std::set<int>::const_iterator ci = cpus.begin(); ci != cpus.end(); ++ci)
+    {
+        int n = axis.size();
+        axis[*ci] = n;
+    }
+
+    std::ostringstream tics;
+    for (std::map<int,int>::const_iterator ai = axis.begin(); ai != axis.end(); ++ai)
+        tics << (ai == axis.begin() ? "" : ", ") << "'" << ai->first << "' " << ai->second;
+
+    // values are labeled only if the cells are large enough
+    bool labels = (axis.size() <= 16);
+    int label = 2;
+
+    // the image needs all cells, the diagonal and missing pairs are NaN
+    std::ostringstream datass;
+    for (std::map<int,int>::const_iterator ai = axis.begin(); ai != axis.end(); ++ai)
+    {
+        for (std::map<int,int>::const_iterator bi = axis.begin(); bi != axis.end(); ++bi)
+        {
+            std::map< std::pair<int,int>, double >::const_iterator
+                mi = matrix.find(std::make_pair(ai->first, bi->first));
+
+            datass << ai->second << "\t" << bi->second << "\t";
+            if (mi == matrix.end()) {
+                datass << "NaN\n";
+                continue;
+            }
+            datass << std::setprecision(20) << mi->second << "\n";
+
+            if (!labels) continue;
+            std::ostringstream value;
+            value << std::fixed << std::setprecision(0) << mi->second;
+            P("set label " << label++ << " '" << value.str() << "' at "
+              << ai->second << "," << bi->second << " center front");
+        }
+    }
+
+    P("set title '" << g_hostname << " - Core-to-Core Round Trip Time [ns] - " << funcname << "'");
+    P("set xtics (" << tics.str() << ")");
+    P("set ytics (" << tics.str() << ")");
+    P("set xrange [-0.5:" << axis.size() - 0.5 << "]");
+    P("set yrange [-0.5:" << axis.size() - 0.5 << "]");
+    P("plot '-' using 1:2:3 with image notitle");
+    os << datass.str() << "e" << std::endl;
+
+    for (int l = 2; l < label; ++l)
+        P("unset label " << l);
+}
+
+/// Heatmaps of the core-to-core ping-pong: one per funcname
+void plot_pingpong(std::ostream& os)
+{
+    if (g_pingpong_results.size() == 0) return;
+
+    P("set xlabel 'CPU'");
+    P("set ylabel 'CPU'");
+    P("set grid noxtics noytics");
+    P("set palette rgbformulae 22,13,-31");
+
+    std::set<std::string> funcnames;
+    for (size_t i = 0; i < g_pingpong_results.size(); ++i)
+    {
+        if (funcnames.insert(*g_pingpong_results[i].funcname).second)
+            plot_pingpong_funcname(os, *g_pingpong_results[i].funcname);
+    }
+
+    P("set xrange [*:*]");
+    P("set yrange [*:*]");
+    P("set xtics 1");
+    P("set ytics auto");
+    P("set grid xtics ytics");
+    P("set xlabel 'Array Size log_2 [B]'");
+}
+
+/// Barrier microbenchmark: cost of one barrier wait over the thread count,
+/// one plotline per barrier implementation
+void plot_barrier(std::ostream& os)
+{
+    if (g_barrier_results.size() == 0) return;
+
+    // map barrier -> nthreads -> time per barrier
+    std::map< std::string, std::map<size_t,double> > curves;
+
+    for (size_t i = 0; i < g_barrier_results.size(); ++i)
+    {
+        const Result& r = g_barrier_results[i];
+        curves[*r.barrier][r.nthreads] = r.rate;
+    }
+
+    std::ostringstream datass;
+    std::vector<std::string> plotlines;
+
+    for (std::map< std::string, std::map<size_t,double> >::const_iterator
+             ci = curves.begin(); ci != curves.end(); ++ci)
+    {
+        plotlines.push_back("'-' using 1:2 title '" + ci->first + "' with linespoints");
+
+        for (std::map<size_t,double>::const_iterator
+                 pi = ci->second.begin(); pi != ci->second.end(); ++pi)
+        {
+            datass << pi->first << "\t" << std::setprecision(20) << pi->second * 1e9 << "\n";
+        }
+        datass << "e\n";
+    }
+
+    P("set key top left");
+    P("set title '" << g_hostname << " - Barrier Wait Time'");
+    P("set xlabel 'Threads [1]'");
+    P("set ylabel 'Time per Barrier [ns]'");
+    P("set yrange [0:*]");
+    join_plotlines(os, plotlines, datass);
+
+    P("set yrange [*:*]");
+    P("set xlabel 'Array Size log_2 [B]'");
+}
+
+void output_gnuplot_header(std::ostream& os)
+{
+    P("set terminal pdf size 28cm,19.6cm linewidth 2.0 font \"Arial,18\" enhanced");
+    P("set output '" << g_gnuplot_output << "'");
+    P("");
+    P("set pointsize 0.7");
+    P("set style line 6 lc rgb '#f0b000'");
+    P("set style line 15 lc rgb '#f0b000'");
+    P("set style line 24 lc rgb '#f0b000'");
+    P("set style line 33 lc rgb '#f0b000'");
+    P("set style line 42 lc rgb '#f0b000'");
+    P("set style line 51 lc rgb '#f0b000'");
+    P("set style line 60 lc rgb '#f0b000'");
+    P("set style increment user");
+    P("");
+    P("set grid xtics ytics");
+    P("set xtics 1");
+    P("set xlabel 'Array Size log_2 [B]'");
+    P("set label 1 'pmbw " VERSION "' right at screen 0.98, screen 0.02");
+}
+
+void output_gnuplot(std::ostream& os)
+{
+    output_gnuplot_header(os);
+
+    plot_sequential(os);
+    plot_chains(os);
+    plot_strides(os);
+    plot_parallel(os);
+    plot_loaded(os);
+    plot_numamatrix(os);
+    plot_barrier(os);
+    plot_assoc(os);
+    plot_tlb(os);
+    plot_pingpong(os);
+}
+
+// ****************************************************************************
+// *** Plateau and knee detection in bandwidth curves
+
+/// relative bandwidth change between adjacent array sizes still counted as a
+/// plateau, and between a point and its plateau's first point
+static const double plateau_step_tolerance = 0.08;
+static const double plateau_drift_tolerance = 0.15;
+
+/// minimum relative bandwidth difference of two adjacent plateaus, closer ones
+/// are merged
+static const double plateau_merge_tolerance = 0.30;
+
+/// a range of array sizes with about constant bandwidth, e.g. one cache level
+struct Plateau
+{
+    size_t first, last;         // indexes of first and last point in curve
+    double bandwidth, rate;     // medians over the plateau's points
+};
+
+/// relative difference of two positive values
+static inline double reldiff(double a, double b)
+{
+    return std::max(a, b) / std::min(a, b) - 1.0;
+}
+
+/// median of a value of a curve's points from first to last
+static double curve_median(const std::vector<const Result*>& curve,
+                           size_t first, size_t last, double Result::* field)
+{
+    std::vector<double> v;
+    for (size_t i = first; i <= last; ++i)
+        v.push_back(curve[i]->*field);
+
+    std::sort(v.begin(), v.end());
+    return (v[(v.size() - 1) / 2] + v[v.size() / 2]) / 2;
+}
+
+/// find plateaus in one curve of results ordered by testsize. Runs of at
+/// least two points, whose bandwidth changes little between neighbours and
+/// does not drift away from the run's start, form plateau candidates. Then
+/// the closest adjacent candidates are merged until all levels differ
+/// clearly, such that outliers and gradual slopes do not split a cache level.
+static std::vector<Plateau> find_plateaus(const std::vector<const Result*>& curve)
+{
+    std::vector<Plateau> runs;
+
+    size_t start = 0;
+    for (size_t i = 1; i <= curve.size(); ++i)
+    {
+        if (i < curve.size() &&
+            reldiff(curve[i]->bandwidth, curve[i-1]->bandwidth) < plateau_step_tolerance &&
+            reldiff(curve[i]->bandwidth, curve[start]->bandwidth) < plateau_drift_tolerance)
+            continue;
+
+        // run start..i-1 ends here
+        if (i - start >= 2)
+        {
+            Plateau p;
+            p.first = start, p.last = i - 1;
+            p.bandwidth = curve_median(curve, p.first, p.last, &Result::bandwidth);
+            p.rate = curve_median(curve, p.first, p.last, &Result::rate);
+            runs.push_back(p);
+        }
+        start = i;
+    }
+
+    while (runs.size() >= 2)
+    {
+        size_t m = 0;
+        for (size_t k = 1; k + 1 < runs.size(); ++k)
+        {
+            if (reldiff(runs[k].bandwidth, runs[k+1].bandwidth) <
+                reldiff(runs[m].bandwidth, runs[m+1].bandwidth))
+                m = k;
+        }
+        if (reldiff(runs[m].bandwidth, runs[m+1].bandwidth) >= plateau_merge_tolerance)
+            break;
+
+        Plateau& p = runs[m];
+        p.last = runs[m+1].last;
+        p.bandwidth = curve_median(curve, p.first, p.last, &Result::bandwidth);
+        p.rate = curve_median(curve, p.first, p.last, &Result::rate);
+        runs.erase(runs.begin() + m + 1);
+    }
+
+    return runs;
+}
+
+/// estimate the array size of the knee between two plateaus as the size where
+/// the bandwidth crosses the geometric mean of both levels, interpolated on
+/// the log2 size axis.
+static double find_knee(const std::vector<const Result*>& curve,
+                        const Plateau& a, const Plateau& b)
+{
+    double level = sqrt(a.bandwidth * b.bandwidth);
+    bool falling = (b.bandwidth < a.bandwidth);
+
+    for (size_t i = a.last + 1; i <= b.first; ++i)
+    {
+        double y0 = curve[i-1]->bandwidth, y1 = curve[i]->bandwidth;
+        if (falling ? (y1 > level) : (y1 < level)) continue;
+
+        double x0 = log2((double)curve[i-1]->testsize);
+        double x1 = log2((double)curve[i]->testsize);
+        double t = (y0 == y1) ? 1.0 : (y0 - level) / (y0 - y1);
+        return exp2(x0 + std::max(0.0, std::min(1.0, t)) * (x1 - x0));
+    }
+
+    return curve[b.first]->testsize;
+}
+
+/// parse a comma-separated list of numbers
+static std::vector<size_t> parse_number_list(const std::string& str)
+{
+    std::vector<size_t> list;
+    const char* s = str.c_str();
+    while (*s)
+    {
+        char* endp;
+        list.push_back(strtoull(s, &endp, 10));
+        if (endp == s) break;
+        s = (*endp == ',') ? endp + 1 : endp;
+    }
+    return list;
+}
+
+/// cache level of a plateau: the smallest level whose capacity, as recorded
+/// by pmbw and scaled by the caches used by the threads of the curve, holds
+/// the geometric mean of the plateau's size range. Returns 0 if the plateau
+/// lies beyond all caches, and -1 if the results carry no cache sizes.
+static int plateau_level(const std::vector<const Result*>& curve, const Plateau& pl)
+{
+    const Result& r = *curve[pl.first];
+    std::vector<size_t> sizes = parse_number_list(*r.cachesizes);
+    std::vector<size_t> sharing = parse_number_list(*r.cachesharing);
+    if (sizes.empty()) return -1;
+
+    double size = sqrt((double)curve[pl.first]->testsize * curve[pl.last]->testsize);
+
+    for (size_t k = 0; k < sizes.size(); ++k)
+    {
+        size_t share = (k < sharing.size() && sharing[k]) ? sharing[k] : 1;
+        double capacity = (double)sizes[k] * ((r.nthreads + share - 1) / share);
+        if (size <= capacity) return k + 1;
+    }
+    return 0;
+}
+
+/// name of the p-th plateau at the given cache level: L1, L2, ..., mem beyond
+/// all caches, or plain plateau numbers P1, P2, ... if the level is unknown
+static std::string plateau_label(size_t p, int level)
+{
+    if (level < 0) return "P" + toStr(p + 1);
+    if (level == 0) return "mem";
+    return "L" + toStr(level);
+}
+
+/// name of the p-th of n plateaus of the TLB probe: dTLB, STLB, ... and walk
+/// for the last one
+static std::string tlb_plateau_label(size_t p, size_t n)
+{
+    if (p + 1 == n && p != 0) return "walk";
+    if (p == 0) return "dTLB";
+    if (p == 1) return "STLB";
+    return "TLB" + toStr(p + 1);
+}
+
+// ****************************************************************************
+// *** Associativity detection from cache set conflicts
+
+/// minimum relative increase of the access time over all fewer addresses,
+/// which counts as a jump to the next cache level
+static const double assoc_jump_tolerance = 0.25;
+
+/// associativity of one cache level detected by the assoc probe
+struct AssocLevel
+{
+    size_t ways;                // addresses fitting into one set
+    size_t stride;              // smallest stride showing the jump: set span
+    double rate;                // median access time below the jump
+    double above;               // access time after the jump
+
+    /// capacity of the level: ways times the set span
+    size_t capacity() const { return ways * stride; }
+
+    /// order by capacity, i.e. by cache level
+    bool operator< (const AssocLevel& b) const
+    { return capacity() < b.capacity(); }
+};
+
+/// order of TLB results: (pagesize,pages)
+static bool tlb_order(const Result& a, const Result& b)
+{
+    if (a.pagesize == b.pagesize) return a.pages < b.pages;
+    return a.pagesize < b.pagesize;
+}
+
+/// order of assoc results: (stride,addresses)
+static bool assoc_order(const Result& a, const Result& b)
+{
+    if (a.stride == b.stride) return a.addresses < b.addresses;
+    return a.stride < b.stride;
+}
+
+/// find the access time jumps in one curve of assoc results ordered by
+/// addresses, each is the first point exceeding the associativity of the next
+/// cache level. A jump must exceed all previous points clearly, be confirmed
+/// by the following point, and the steadily rising points after it belong to
+/// the same transition, such that gradual replacement does not count twice.
+static std::vector<AssocLevel> find_assoc_levels(const std::vector<const Result*>& curve)
+{
+    std::vector<AssocLevel> levels;
+    if (curve.empty()) return levels;
+
+    double maxrate = curve[0]->rate;
+    size_t first = 0, i = 1;
+
+    while (i < curve.size())
+    {
+        bool jump = curve[i]->rate > maxrate * (1.0 + assoc_jump_tolerance) &&
+            (i + 1 == curve.size() ||
+             curve[i+1]->rate > maxrate * (1.0 + assoc_jump_tolerance));
+
+        if (!jump) {
+            maxrate = std::max(maxrate, curve[i++]->rate);
+            continue;
+        }
+
+        AssocLevel al;
+        al.ways = curve[i-1]->addresses;
+        al.stride = curve[i]->stride;
+        al.rate = curve_median(curve, first, i-1, &Result::rate);
+
+        // skip the transition to the next level
+        maxrate = curve[i++]->rate;
+        while (i < curve.size() &&
+               curve[i]->rate > curve[i-1]->rate * (1.0 + plateau_step_tolerance))
+            maxrate = curve[i++]->rate;
+        first = i;
+
+        al.above = maxrate;
+        levels.push_back(al);
+    }
+
+    return levels;
+}
+
+/// detect the associativity of each cache level from the strides in
+/// ascending order. Larger strides conflict in all levels whose set span
+/// divides them, hence a jump at the same number of addresses as one of a
+/// smaller stride, which it is a multiple of, to no slower access time is
+/// explained by that level. Other jumps add levels, whose set span is the
+/// stride they first appear at. Strides above the backing page size map to
+/// random physical sets and also conflict in the dTLB, they are ignored.
+/// Returns the levels ordered by capacity.
+static std::vector<AssocLevel> detect_assoc_levels()
+{
+    std::vector<AssocLevel> levels;
+
+    size_t i = 0;
+    while (i < g_assoc_results.size())
+    {
+        std::vector<const Result*> curve;
+        size_t j = i;
+        for (; j < g_assoc_results.size() && g_assoc_results[j].stride == g_assoc_results[i].stride; ++j)
+            curve.push_back(&g_assoc_results[j]);
+        i = j;
+
+        if (curve[0]->pagesize == 0 || curve[0]->stride > curve[0]->pagesize) {
+            WARN("Ignoring assoc stride " << curve[0]->stride << " above the page size "
+                 << curve[0]->pagesize << ".");
+            continue;
+        }
+
+        std::vector<AssocLevel> cl = find_assoc_levels(curve);
+        for (size_t k = 0; k < cl.size(); ++k)
+        {
+            bool explained = false;
+            for (size_t l = 0; l < levels.size(); ++l)
+            {
+                explained = explained ||
+                    (levels[l].ways == cl[k].ways && cl[k].stride % levels[l].stride == 0 &&
+                     cl[k].above <= levels[l].above * (1.0 + assoc_jump_tolerance));
+            }
+
+            if (!explained) levels.push_back(cl[k]);
+        }
+    }
+
+    std::sort(levels.begin(), levels.end());
+    return levels;
+}
+
+/// cache level of an associativity level: the recorded cache size closest to
+/// its capacity within a factor of two, or -1 if none.
+static int assoc_cache_level(const AssocLevel& al, const std::vector<size_t>& sizes)
+{
+    int level = -1;
+    double best = 1.0;
+    for (size_t k = 0; k < sizes.size(); ++k)
+    {
+        double dist = fabs(log2((double)al.capacity() / sizes[k]));
+        if (dist <= best) level = k + 1, best = dist;
+    }
+    return level;
+}
+
+/// associativity level matching a plateau: with recorded cache sizes the one
+/// whose capacity is closest to the plateau's cache level, otherwise the one
+/// whose capacity is closest to the plateau's largest thread size within its
+/// size range up to twice as large. NULL if none matches.
+static const AssocLevel* plateau_assoc(const std::vector<AssocLevel>& assoc,
+                                       const std::vector<const Result*>& curve,
+                                       const Plateau& pl, int level)
+{
+    if (level == 0) return NULL;
+
+    std::vector<size_t> sizes = parse_number_list(*curve[pl.first]->cachesizes);
+    double lo = curve[pl.first]->threadsize, hi = curve[pl.last]->threadsize;
+
+    const AssocLevel* match = NULL;
+    double best = 1.0;
+    for (size_t k = 0; k < assoc.size(); ++k)
+    {
+        double capacity = assoc[k].capacity(), dist;
+        if (level > 0)
+            dist = fabs(log2(capacity / sizes[level-1]));
+        else if (capacity >= lo && capacity <= 2 * hi)
+            dist = fabs(log2(capacity / hi));
+        else
+            continue;
+
+        if (dist <= best) match = &assoc[k], best = dist;
+    }
+    return match;
+}
+
+/// output a tab-separated table of the plateaus of each funcname and thread
+/// count: the cache level L1, L2, ... or mem matched by the recorded cache
+/// sizes, the testsize range, plateau bandwidth and access time, and the knee
+/// to the next plateau. The associativity detected by the assoc probe is
+/// added as the ways column to the plateau it matches by capacity, and listed
+/// in own rows with the set span and capacity.
+void output_summary(std::ostream& os)
+{
+    std::vector<AssocLevel> assoc = detect_assoc_levels();
+
+    if (assoc.empty() && !g_results.empty())
+        ERR("No associativity detected in assoc mode results, the ways column is empty.");
+
+    os << "funcname\tnthreads\tlevel\tminsize\tmaxsize\tpoints"
+       << "\tbandwidth[GiB/s]\taccesstime[ns]\tkneesize\tways" << std::endl;
+
+    size_t i = 0;
+    while (i < g_results.size())
+    {
+        // collect curve of one funcname and thread count
+        std::vector<const Result*> curve;
+        size_t j = i;
+        for (; j < g_results.size() && *g_results[j].funcname == *g_results[i].funcname &&
+                 g_results[j].nthreads == g_results[i].nthreads; ++j)
+        {
+            if (!curve.empty() && curve.back()->testsize == g_results[j].testsize) {
+                WARN("Multiple results found for " << *g_results[j].funcname
+                     << " testsize " << g_results[j].testsize << ", ignoring second.");
+                continue;
+            }
+            if (g_results[j].bandwidth <= 0) continue;
+            curve.push_back(&g_results[j]);
+        }
+        i = j;
+
+        std::vector<Plateau> plateaus = find_plateaus(curve);
+
+        for (size_t p = 0; p < plateaus.size(); ++p)
+        {
+            const Plateau& pl = plateaus[p];
+            int level = plateau_level(curve, pl);
+
+            os << *curve[pl.first]->funcname << '\t' << curve[pl.first]->nthreads << '\t'
+               << plateau_label(p, level)
+               << '\t' << curve[pl.first]->testsize
+               << '\t' << curve[pl.last]->testsize
+               << '\t' << pl.last - pl.first + 1
+               << '\t' << std::setprecision(4) << pl.bandwidth / 1024/1024/1024
+               << '\t' << std::setprecision(4) << pl.rate * 1e9 << '\t';
+            if (p + 1 < plateaus.size())
+                os << (size_t)find_knee(curve, pl, plateaus[p+1]);
+            os << '\t';
+            if (const AssocLevel* al = plateau_assoc(assoc, curve, pl, level))
+                os << al->ways;
+            os << std::endl;
+        }
+    }
+
+    // the conflicting addresses span ways times the stride, levels are named
+    // by the recorded cache sizes, or A1, A2, ... if they match none
+    std::vector<size_t> cachesizes;
+    if (!g_assoc_results.empty())
+        cachesizes = parse_number_list(*g_assoc_results[0].cachesizes);
+
+    for (size_t k = 0; k < assoc.size(); ++k)
+    {
+        int level = assoc_cache_level(assoc[k], cachesizes);
+
+        os << "AssocRead64\t1\t" << (level > 0 ? "L" + toStr(level) : "A" + toStr(k + 1))
+           << '\t' << assoc[k].stride
+           << '\t' << assoc[k].stride * assoc[k].ways
+           << '\t' << assoc[k].ways
+           << "\t\t" << std::setprecision(4) << assoc[k].rate * 1e9
+           << "\t\t" << assoc[k].ways << std::endl;
+    }
+
+    // TLB levels of each page size, the sizes are the reach of the pages and
+    // the knee is the reach of the level
+    i = 0;
+    while (i < g_tlb_results.size())
+    {
+        std::vector<const Result*> curve;
+        size_t j = i;
+        for (; j < g_tlb_results.size() && g_tlb_results[j].pagesize == g_tlb_results[i].pagesize; ++j)
+            curve.push_back(&g_tlb_results[j]);
+        i = j;
+
+        std::vector<Plateau> plateaus = find_plateaus(curve);
+
+        for (size_t p = 0; p < plateaus.size(); ++p)
+        {
+            const Plateau& pl = plateaus[p];
+
+            os << "TlbRead64-" << pagesize_label(curve[pl.first]->pagesize) << "\t1\t"
+               << tlb_plateau_label(p, plateaus.size())
+               << '\t' << curve[pl.first]->testsize
+               << '\t' << curve[pl.last]->testsize
+               << '\t' << pl.last - pl.first + 1
+               << '\t' << std::setprecision(4) << pl.bandwidth / 1024/1024/1024
+               << '\t' << std::setprecision(4) << pl.rate * 1e9 << '\t';
+            if (p + 1 < plateaus.size())
+                os << (size_t)find_knee(curve, pl, plateaus[p+1]);
+            os << "\t" << std::endl;
+        }
+    }
+}
+
+// ****************************************************************************
+// *** Comparison of several hosts and runs
+
+/// assign the series of each result: one per host, or one per host and input
+/// file if the host's results are spread over several files
+void assign_series()
+{
+    std::map<std::string, std::set<size_t> > host_runs;
+    for (size_t i = 0; i < g_results.size(); ++i)
+        host_runs[*g_results[i].host].insert(g_results[i].run);
+
+    std::map<std::pair<std::string, size_t>, size_t> series_ids;
+    for (size_t i = 0; i < g_results.size(); ++i)
+    {
+        Result& r = g_results[i];
+        bool several_runs = (host_runs[*r.host].size() > 1);
+        std::pair<std::string, size_t> key(*r.host, several_runs ? r.run : 0);
+
+        std::map<std::pair<std::string, size_t>, size_t>::iterator
+            it = series_ids.find(key);
+        if (it == series_ids.end())
+        {
+            it = series_ids.insert(std::make_pair(key, g_series_names.size())).first;
+            g_series_names.push_back(
+                several_runs ? *r.host + " (" + g_run_names[r.run] + ")" : *r.host);
+        }
+        r.series = it->second;
+    }
+}
+
+/// collect the curve of one funcname and thread count of each series, ordered
+/// by testsize. nthreads 0 selects the largest thread count of each series.
+static std::vector< std::vector<const Result*> >
+series_curves(size_t funcname_id, size_t nthreads)
+{
+    std::vector<size_t> series_nthreads(g_series_names.size(), nthreads);
+    if (nthreads == 0)
+    {
+        for (size_t i = 0; i < g_results.size(); ++i)
+        {
+            const Result& r = g_results[i];
+            if (r.funcname_id != funcname_id) continue;
+            series_nthreads[r.series] = std::max(series_nthreads[r.series], r.nthreads);
+        }
+    }
+
+    std::vector< std::vector<const Result*> > curves(g_series_names.size());
+    for (size_t i = 0; i < g_results.size(); ++i)
+    {
+        const Result& r = g_results[i];
+        if (r.funcname_id != funcname_id || r.nthreads != series_nthreads[r.series])
+            continue;
+
+        std::vector<const Result*>& curve = curves[r.series];
+        if (!curve.empty() && curve.back()->testsize == r.testsize) {
+            WARN("Multiple results found for " << *r.funcname << " on " << g_series_names[r.series]
+                 << " testsize " << r.testsize << ", ignoring second.");
+            continue;
+        }
+        if (r.bandwidth <= 0) continue;
+        curve.push_back(&r);
+    }
+
+    return curves;
+}
+
+/// bandwidth of a curve at a testsize, interpolated on the log2 size axis, as
+/// hosts may have been tested with different array sizes.
+static bool curve_bandwidth_at(const std::vector<const Result*>& curve,
+                               size_t testsize, double& out)
+{
+    for (size_t i = 0; i < curve.size(); ++i)
+    {
+        if (curve[i]->testsize < testsize) continue;
+        if (curve[i]->testsize == testsize) {
+            out = curve[i]->bandwidth;
+            return true;
+        }
+        if (i == 0) return false;
+
+        double x0 = log2((double)curve[i-1]->testsize), x1 = log2((double)curve[i]->testsize);
+        double t = (log2((double)testsize) - x0) / (x1 - x0);
+        out = curve[i-1]->bandwidth + t * (curve[i]->bandwidth - curve[i-1]->bandwidth);
+        return true;
+    }
+    return false;
+}
+
+/// Plot procedure: one plotline per series of the curves of one funcname
+void plot_compare_curves(std::ostream& os, const std::vector< std::vector<const Result*> >& curves,
+                         bool show_nthreads, data_print_func print_func)
+{
+    std::ostringstream datass;
+    std::vector<std::string> plotlines;
+
+    for (size_t s = 0; s < curves.size(); ++s)
+    {
+        if (curves[s].empty()) continue;
+
+        std::string title = g_series_names[s];
+        if (show_nthreads)
+            title += " (" + toStr(curves[s][0]->nthreads) + " threads)";
+        plotlines.push_back("'-' using 1:2 title '" + title + "' with linespoints");
+
+        for (size_t i = 0; i < curves[s].size(); ++i)
+            print_func(datass, *curves[s][i]);
+        datass << "e\n";
+    }
+
+    join_plotlines(os, plotlines, datass);
+}
+
+/// Plot procedure: bandwidth of each series relative to the first one
+void plot_compare_ratio(std::ostream& os, const std::vector< std::vector<const Result*> >& curves,
+                        size_t reference)
+{
+    std::ostringstream datass;
+    std::vector<std::string> plotlines;
+
+    for (size_t s = 0; s < curves.size(); ++s)
+    {
+        if (s == reference || curves[s].empty()) continue;
+
+        std::ostringstream linedata;
+        for (size_t i = 0; i < curves[s].size(); ++i)
+        {
+            const Result& r = *curves[s][i];
+            double refbw;
+            if (!curve_bandwidth_at(curves[reference], r.testsize, refbw) || refbw <= 0)
+                continue;
+
+            linedata << std::setprecision(20)
+                     << log(r.testsize) / log(2) << "\t"
+                     << r.bandwidth / refbw << "\n";
+        }
+        if (linedata.str().empty()) continue;
+
+        plotlines.push_back("'-' using 1:2 title '" + g_series_names[s] + "' with linespoints");
+        datass << linedata.str() << "e\n";
+    }
+
+    join_plotlines(os, plotlines, datass);
+}
+
+/// Plots comparing one funcname on all hosts and runs
+void plot_compare_funcname(std::ostream& os, size_t funcname_id, const std::string& funcname)
+{
+    bool latency = (funcname.find("Perm") != std::string::npos);
+
+    std::vector< std::vector<const Result*> > curves = series_curves(funcname_id, 1);
+
+    P("set key " << (latency ? "top left" : "top right"));
+    P("set yrange [0:*]");
+    if (latency) {
+        P("set title 'Comparison - One Thread Memory Latency (Access Time) - " << funcname << "'");
+        P("set ylabel 'Access Time [ns]'");
+        plot_compare_curves(os, curves, false, plot_data_latency);
+    }
+    else {
+        P("set title 'Comparison - One Thread Memory Bandwidth - " << funcname << "'");
+        P("set ylabel 'Bandwidth [GiB/s]'");
+        plot_compare_curves(os, curves, false, plot_data_bandwidth);
+    }
+
+    // reference is the first series with results
+    size_t reference = 0;
+    while (reference < curves.size() && curves[reference].empty()) ++reference;
+
+    if (reference < curves.size())
+    {
+        P("set key top right");
+        P("set title 'Comparison - One Thread Bandwidth Relative to "
+          << g_series_names[reference] << " - " << funcname << "'");
+        P("set ylabel 'Bandwidth Ratio [1]'");
+        plot_compare_ratio(os, curves, reference);
+    }
+
+    curves = series_curves(funcname_id, 0);
+
+    P("set key top right");
+    P("set title 'Comparison - Parallel Memory Bandwidth with Most Threads - " << funcname << "'");
+    P("set ylabel 'Bandwidth [GiB/s]'");
+    plot_compare_curves(os, curves, true, plot_data_bandwidth);
+}
+
+/// output a gnuplot script comparing all funcnames on all hosts and runs
+void output_compare_gnuplot(std::ostream& os)
+{
+    output_gnuplot_header(os);
+
+    size_t funcname_id = (size_t)-1;
+    for (size_t i = 0; i < g_results.size(); ++i)
+    {
+        if (g_results[i].funcname_id == funcname_id) continue;
+        funcname_id = g_results[i].funcname_id;
+        plot_compare_funcname(os, funcname_id, *g_results[i].funcname);
+    }
+}
+
+/// overlap of the testsize ranges of two plateaus on the log2 size axis
+static double plateau_overlap(const std::vector<const Result*>& ca, const Plateau& a,
+                              const std::vector<const Result*>& cb, const Plateau& b)
+{
+    double lo = std::max(ca[a.first]->testsize, cb[b.first]->testsize);
+    double hi = std::min(ca[a.last]->testsize, cb[b.last]->testsize);
+    return (lo <= hi) ? log2(hi) - log2(lo) : -1;
+}
+
+/// output a tab-separated table of the plateau bandwidth of each cache level
+/// on all hosts and runs, for one thread and for the most threads of each
+/// host, if more than one. The ratio is relative to the plateau of the first
+/// series overlapping most in testsize range, as hosts with different caches
+/// may have different numbers of plateaus.
+void output_compare_summary(std::ostream& os)
+{
+    os << "funcname\tthreads\tlevel\tseries\tnthreads\tminsize\tmaxsize"
+       << "\tbandwidth[GiB/s]\taccesstime[ns]\tratio" << std::endl;
+
+    size_t funcname_id = (size_t)-1;
+    for (size_t i = 0; i < g_results.size(); ++i)
+    {
+        if (g_results[i].funcname_id == funcname_id) continue;
+        funcname_id = g_results[i].funcname_id;
+
+        for (size_t nthreads = 1; ; nthreads = 0)
+        {
+            std::vector< std::vector<const Result*> > curves = series_curves(funcname_id, nthreads);
+
+            // plateaus of the reference series
+            const std::vector<const Result*>* reference = NULL;
+            std::vector<Plateau> ref_plateaus;
+
+            for (size_t s = 0; s < curves.size(); ++s)
+            {
+                if (curves[s].empty()) continue;
+
+                // the most threads are the single thread rows again
+                if (nthreads == 0 && curves[s][0]->nthreads == 1) continue;
+
+                std::vector<Plateau> plateaus = find_plateaus(curves[s]);
+                for (size_t p = 0; p < plateaus.size(); ++p)
+                {
+                    const Plateau& pl = plateaus[p];
+                    std::string level = plateau_label(p, plateau_level(curves[s], pl));
+
+                    // reference plateau overlapping most in size range
+                    const Plateau* ref = NULL;
+                    double ref_overlap = 0;
+                    for (size_t q = 0; reference && q < ref_plateaus.size(); ++q)
+                    {
+                        double overlap = plateau_overlap(curves[s], pl, *reference, ref_plateaus[q]);
+                        if (overlap >= 0 && (!ref || overlap > ref_overlap))
+                            ref = &ref_plateaus[q], ref_overlap = overlap;
+                    }
+
+                    os << *g_results[i].funcname << '\t'
+                       << (nthreads ? "one" : "most") << '\t'
+                       << level << '\t'
+                       << g_series_names[s] << '\t'
+                       << curves[s][pl.first]->nthreads << '\t'
+                       << curves[s][pl.first]->testsize << '\t'
+                       << curves[s][pl.last]->testsize << '\t'
+                       << std::setprecision(4) << pl.bandwidth / 1024/1024/1024 << '\t'
+                       << std::setprecision(4) << pl.rate * 1e9 << '\t';
+                    if (!reference)
+                        os << 1;
+                    else if (ref)
+                        os << std::setprecision(4) << pl.bandwidth / ref->bandwidth;
+                    os << std::endl;
+                }
+
+                if (!reference) {
+                    reference = &curves[s];
+                    ref_plateaus = plateaus;
+                }
+            }
+
+            if (nthreads == 0) break;
+        }
+    }
+}
+
+/// predicate selecting results of special modes, not array size sweeps
+static bool is_mode_result(const Result& r)
+{
+    return (*r.mode == "numamatrix" || *r.mode == "loaded" || *r.mode == "barrier" ||
+            *r.mode == "assoc" || *r.mode == "tlb" || *r.mode == "pingpong" ||
+            r.stride != 0);
+}
+
+/// main: read stdin or from all files on the command line
+int main(int argc, char* argv[])
+{
+    std::string opt_hostname_override;
+    std::string opt_gnuplot_output_override;
+    bool opt_summary = false;
+    bool opt_compare = false;
+
+    if (argc == 1) {
+        process_stream(std::cin, "stdin");
+    }
+    else
+    {
+        // *** parse command line options
+        int opt;
+
+        while ( (opt = getopt(argc, argv, "cvh:j:o:s")) != -1 )
+        {
+            switch (opt) {
+            case 'c':
+                opt_compare = true;
+                ERR("Comparing results of all hosts and input files.");
+                break;
+
+            case 'h':
+                opt_hostname_override = optarg;
+                ERR("Setting hostname override to '" << opt_hostname_override << "'");
+                break;
+
+            case 'j':
+                gopt_parse_threads = atoi(optarg);
+                if (gopt_parse_threads < 1) gopt_parse_threads = 1;
+                ERR("Parsing input with " << gopt_parse_threads << " threads.");
                 break;
 
             case 'o':
@@ -661,22 +2400,32 @@ int main(int argc, char* argv[])
                 ERR("Setting gnuplot output override to '" << opt_gnuplot_output_override << "'");
                 break;
 
+            case 's':
+                opt_summary = true;
+                ERR("Outputting a table of bandwidth plateaus instead of a gnuplot script.");
+                break;
+
             case 'v':
                 gopt_warnings = true;
                 ERR("Outputting verbose warnings when processing plots.");
                 break;
 
             default: /* '?' */
-                ERR("Usage: " << argv[0] << " [-v] [-h hostname] [files...]");
+                ERR("Usage: " << argv[0] << " [-v] [-s] [-c] [-j threads] [-h hostname] [-o output] [files...]");
                 exit(EXIT_FAILURE);
             }
         }
 
+        if (optind == argc) // no files given
+            process_stream(std::cin, "stdin");
+
         while (optind < argc) { // process files
             process_file(argv[optind++]);
         }
     }
 
+    assign_funcname_ids();
+
     if (g_results.size() == 0) {
         ERR("No RESULT lines found in input.");
         return 0;
@@ -685,10 +2434,10 @@ int main(int argc, char* argv[])
         ERR("Parsed " << g_results.size() << " RESULT lines in input.");
     }
 
-    if (!check_multiple_hosts())
+    if (!check_multiple_hosts() && !opt_compare)
     {
         if (!opt_hostname_override.size()) {
-            ERR("Use -h <hostname> to override the hostnames if this is intentional.");
+            ERR("Use -c to compare the hosts, or -h <hostname> to override the hostnames if this is intentional.");
             return 0;
         }
     }
@@ -698,12 +2447,51 @@ int main(int argc, char* argv[])
 
     g_gnuplot_output = "plots-" + g_hostname + ".pdf";
 
+    if (opt_compare) {
+        assign_series();
+        g_gnuplot_output = "plots-compare.pdf";
+    }
+
     if (opt_gnuplot_output_override.size())
         g_gnuplot_output = opt_gnuplot_output_override;
 
-    std::sort(g_results.begin(), g_results.end());
+    // separate NUMA matrix, loaded latency, barrier, associativity, TLB,
+    // ping-pong and strided results from the array size sweeps
+    for (size_t i = 0; i < g_results.size(); ++i)
+    {
+        if (*g_results[i].mode == "numamatrix")
+            g_matrix_results.push_back(g_results[i]);
+        else if (*g_results[i].mode == "loaded")
+            g_loaded_results.push_back(g_results[i]);
+        else if (*g_results[i].mode == "barrier")
+            g_barrier_results.push_back(g_results[i]);
+        else if (*g_results[i].mode == "assoc")
+            g_assoc_results.push_back(g_results[i]);
+        else if (*g_results[i].mode == "tlb")
+            g_tlb_results.push_back(g_results[i]);
+        else if (*g_results[i].mode == "pingpong")
+            g_pingpong_results.push_back(g_results[i]);
+        else if (g_results[i].stride != 0)
+            g_stride_results.push_back(g_results[i]);
+    }
+    g_results.erase(std::remove_if(g_results.begin(), g_results.end(), is_mode_result),
+                    g_results.end());
 
-    output_gnuplot(std::cout);
+    std::sort(g_results.begin(), g_results.end());
+    std::sort(g_matrix_results.begin(), g_matrix_results.end());
+    std::sort(g_loaded_results.begin(), g_loaded_results.end());
+    std::sort(g_stride_results.begin(), g_stride_results.end());
+    std::sort(g_assoc_results.begin(), g_assoc_results.end(), assoc_order);
+    std::sort(g_tlb_results.begin(), g_tlb_results.end(), tlb_order);
+
+    if (opt_compare && opt_summary)
+        output_compare_summary(std::cout);
+    else if (opt_compare)
+        output_compare_gnuplot(std::cout);
+    else if (opt_summary)
+        output_summary(std::cout);
+    else
+        output_gnuplot(std::cout);
 
     return 0;
 }